@@ -0,0 +1,175 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "Benchmark.h"
+#include "../src/plugins/ReportWriters.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/regex.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+
+namespace // unnamed
+{
+
+// in seconds
+double measure(Vera::Bench::Case & c, std::size_t iterations)
+{
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    c.run(iterations);
+    const boost::posix_time::ptime end = boost::posix_time::microsec_clock::universal_time();
+    return (end - start).total_microseconds() / 1e6;
+}
+
+// the number of iterations that takes at least the given time
+std::size_t calibrate(Vera::Bench::Case & c, double minTime)
+{
+    std::size_t iterations = 1;
+    while (true)
+    {
+        const double elapsed = measure(c, iterations);
+        if (elapsed >= minTime || iterations >= 1000000000)
+        {
+            return iterations;
+        }
+
+        // aim a bit over the minimum time, but don't grow too fast on a noisy first run
+        std::size_t next = elapsed > 0
+            ? static_cast<std::size_t>(iterations * minTime * 1.2 / elapsed) + 1
+            : iterations * 10;
+        next = std::min(next, iterations * 10);
+        iterations = std::max(next, iterations + 1);
+    }
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const std::size_t size = values.size();
+    if (size == 0)
+    {
+        return 0;
+    }
+    return size % 2 == 1 ? values[size / 2] : (values[size / 2 - 1] + values[size / 2]) / 2;
+}
+
+void appendNumber(std::string & buffer, double value)
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3) << value;
+    buffer += ss.str();
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Bench
+{
+
+Runner::Runner(const RunnerOptions & options)
+    : options_(options)
+{
+}
+
+void Runner::add(CasePtr c)
+{
+    cases_.push_back(c);
+}
+
+const ResultCollection & Runner::run(std::ostream & os)
+{
+    const boost::regex filter(options_.filter_.empty() ? std::string(".") : options_.filter_);
+
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+    os << std::left << std::setw(36) << "benchmark" << std::right << std::setw(14)
+        << "median (ns)" << std::setw(12) << "iterations" << std::setw(14) << "MB/s"
+        << std::setw(16) << "items/s" << '\n';
+
+    results_.clear();
+    for (std::vector<CasePtr>::const_iterator it = cases_.begin(); it != cases_.end(); ++it)
+    {
+        Case & c = **it;
+        if (boost::regex_search(c.getName(), filter) == false)
+        {
+            continue;
+        }
+
+        c.setUp();
+        Result result;
+        result.name_ = c.getName();
+        result.iterations_ = calibrate(c, options_.minTime_);
+        for (int i = 0; i < options_.repetitions_; ++i)
+        {
+            const double elapsed = measure(c, result.iterations_);
+            result.times_.push_back(elapsed * 1e9 / result.iterations_);
+        }
+        result.median_ = median(result.times_);
+        const double seconds = result.median_ / 1e9;
+        result.bytesPerSecond_ = seconds > 0 ? c.getBytes() / seconds : 0;
+        result.itemsPerSecond_ = seconds > 0 ? c.getItems() / seconds : 0;
+        results_.push_back(result);
+
+        os << std::left << std::setw(36) << result.name_ << std::right
+            << std::setw(14) << result.median_
+            << std::setw(12) << result.iterations_
+            << std::setw(14) << result.bytesPerSecond_ / (1024 * 1024)
+            << std::setw(16) << result.itemsPerSecond_ << std::endl;
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+    return results_;
+}
+
+void Runner::writeJson(std::ostream & os, const Context & context) const
+{
+    std::string buffer = "{\n  \"context\": {";
+    for (Context::const_iterator it = context.begin(); it != context.end(); ++it)
+    {
+        buffer += it == context.begin() ? "\n    " : ",\n    ";
+        Plugins::ReportWriter::appendJsonString(buffer, it->first);
+        buffer += ": ";
+        Plugins::ReportWriter::appendJsonString(buffer, it->second);
+    }
+    buffer += context.empty() ? "},\n" : "\n  },\n";
+
+    buffer += "  \"benchmarks\": [";
+    for (ResultCollection::const_iterator it = results_.begin(); it != results_.end(); ++it)
+    {
+        buffer += it == results_.begin() ? "\n" : ",\n";
+        buffer += "    { \"name\": ";
+        Plugins::ReportWriter::appendJsonString(buffer, it->name_);
+
+        std::ostringstream ss;
+        ss << ", \"iterations\": " << it->iterations_;
+        buffer += ss.str();
+        buffer += ", \"time_unit\": \"ns\",\n      \"times\": [";
+        for (std::vector<double>::const_iterator tit = it->times_.begin();
+             tit != it->times_.end(); ++tit)
+        {
+            buffer += tit == it->times_.begin() ? "" : ", ";
+            appendNumber(buffer, *tit);
+        }
+        buffer += "],\n      \"median\": ";
+        appendNumber(buffer, it->median_);
+        buffer += ", \"bytes_per_second\": ";
+        appendNumber(buffer, it->bytesPerSecond_);
+        buffer += ", \"items_per_second\": ";
+        appendNumber(buffer, it->itemsPerSecond_);
+        buffer += " }";
+    }
+    buffer += results_.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+    os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+}
+}
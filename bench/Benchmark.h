@@ -0,0 +1,108 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BENCHMARK_H_INCLUDED
+#define BENCHMARK_H_INCLUDED
+
+#include <boost/shared_ptr.hpp>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace Vera
+{
+namespace Bench
+{
+
+// A measured piece of code. The body is run the requested number of times
+// and the work it does in each iteration gives the throughput.
+class Case
+{
+public:
+    typedef std::string Name;
+
+    explicit Case(const Name & name) : name_(name), bytes_(0), items_(0) {}
+    virtual ~Case() {}
+
+    const Name & getName() const { return name_; }
+
+    // called once, before the calibration
+    virtual void setUp() {}
+    virtual void run(std::size_t iterations) = 0;
+
+    // per iteration
+    std::size_t getBytes() const { return bytes_; }
+    std::size_t getItems() const { return items_; }
+
+protected:
+    void setBytes(std::size_t bytes) { bytes_ = bytes; }
+    void setItems(std::size_t items) { items_ = items; }
+
+private:
+    const Name name_;
+    std::size_t bytes_;
+    std::size_t items_;
+};
+
+typedef boost::shared_ptr<Case> CasePtr;
+
+struct Result
+{
+    Case::Name name_;
+    std::size_t iterations_;
+
+    // the time of an iteration in each repetition, in nanoseconds
+    std::vector<double> times_;
+    double median_;
+
+    double bytesPerSecond_;
+    double itemsPerSecond_;
+};
+
+typedef std::vector<Result> ResultCollection;
+
+struct RunnerOptions
+{
+    RunnerOptions() : repetitions_(5), minTime_(0.5) {}
+
+    int repetitions_;
+
+    // in seconds, for the iterations of a repetition
+    double minTime_;
+
+    // a regex the names of the cases must match, all cases if empty
+    std::string filter_;
+};
+
+class Runner
+{
+public:
+    // the description of the run, written with the results
+    typedef std::vector<std::pair<std::string, std::string> > Context;
+
+    explicit Runner(const RunnerOptions & options);
+
+    void add(CasePtr c);
+
+    // the progress is written to the stream
+    const ResultCollection & run(std::ostream & os);
+
+    void writeJson(std::ostream & os, const Context & context) const;
+
+private:
+    const RunnerOptions options_;
+    std::vector<CasePtr> cases_;
+    ResultCollection results_;
+};
+
+} // namespace Bench
+
+} // namespace Vera
+
+#endif // BENCHMARK_H_INCLUDED
@@ -0,0 +1,349 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "Corpus.h"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+
+namespace // unnamed
+{
+
+// xorshift, to get the same numbers on all the platforms
+class Random
+{
+public:
+    explicit Random(unsigned int seed) : state_(seed == 0 ? 2463534242u : seed) {}
+
+    unsigned int next()
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    int below(int n)
+    {
+        return static_cast<int>(next() % static_cast<unsigned int>(n));
+    }
+
+    bool percent(int p)
+    {
+        return below(100) < p;
+    }
+
+private:
+    unsigned int state_;
+};
+
+typedef std::vector<std::string> LineCollection;
+
+const char * const types[] =
+{
+    "int", "unsigned int", "long", "double", "bool", "char", "std::string",
+    "std::size_t", "std::vector<int>", "const char *"
+};
+
+const char * const words[] =
+{
+    "value", "count", "index", "buffer", "name", "result", "first", "last",
+    "size", "offset", "node", "token", "line", "column", "state", "total"
+};
+
+const char * const operators[] =
+{
+    " + ", " - ", " * ", " / ", " % ", " << ", " >> ", " & ", " | ", " ^ ",
+    " && ", " || ", " == ", " != ", " < ", " <= ", " > ", " >= "
+};
+
+template <typename T, std::size_t N>
+int countOf(T (&)[N])
+{
+    return static_cast<int>(N);
+}
+
+std::string pick(Random & random, const char * const * table, int count)
+{
+    return table[random.below(count)];
+}
+
+std::string identifier(Random & random)
+{
+    std::ostringstream ss;
+    ss << pick(random, words, countOf(words));
+    if (random.percent(50))
+    {
+        ss << '_' << pick(random, words, countOf(words));
+    }
+    if (random.percent(30))
+    {
+        ss << random.below(100);
+    }
+    return ss.str();
+}
+
+std::string literal(Random & random)
+{
+    std::ostringstream ss;
+    switch (random.below(6))
+    {
+    case 0:
+        ss << random.below(100000);
+        break;
+    case 1:
+        ss << "0x" << std::hex << random.next() << std::dec;
+        break;
+    case 2:
+        ss << random.below(1000) << '.' << random.below(1000) << "e" << random.below(10);
+        break;
+    case 3:
+        ss << "\"" << pick(random, words, countOf(words)) << " \\\"quoted\\\" "
+            << pick(random, words, countOf(words)) << "\\n\"";
+        break;
+    case 4:
+        ss << "'" << static_cast<char>('a' + random.below(26)) << "'";
+        break;
+    default:
+        ss << "'\\t'";
+        break;
+    }
+    return ss.str();
+}
+
+std::string expression(Random & random, int terms)
+{
+    std::string res = random.percent(50) ? identifier(random) : literal(random);
+    for (int i = 1; i < terms; ++i)
+    {
+        res += pick(random, operators, countOf(operators));
+        if (random.percent(10))
+        {
+            res += "(" + identifier(random) + " + " + literal(random) + ")";
+        }
+        else
+        {
+            res += random.percent(60) ? identifier(random) : literal(random);
+        }
+    }
+    return res;
+}
+
+void addStatement(Random & random, const Vera::Bench::CorpusOptions & options,
+    const std::string & indent, LineCollection & lines)
+{
+    if (random.percent(options.longLines_))
+    {
+        // a few hundred characters
+        lines.push_back(indent + identifier(random) + " = " + expression(random, 40) + ";");
+        return;
+    }
+    if (random.percent(options.comments_))
+    {
+        if (random.percent(50))
+        {
+            lines.push_back(indent + "// " + identifier(random) + " is computed from the "
+                + identifier(random) + " of the " + identifier(random));
+        }
+        else
+        {
+            lines.push_back(indent + "/* " + identifier(random) + " and");
+            lines.push_back(indent + "   " + identifier(random) + " */");
+        }
+        return;
+    }
+
+    switch (random.below(6))
+    {
+    case 0:
+        lines.push_back(indent + pick(random, types, countOf(types)) + " " + identifier(random)
+            + " = " + expression(random, 1 + random.below(4)) + ";");
+        break;
+    case 1:
+        lines.push_back(indent + "if (" + expression(random, 3) + ")");
+        lines.push_back(indent + "{");
+        lines.push_back(indent + "    return " + expression(random, 2) + ";");
+        lines.push_back(indent + "}");
+        break;
+    case 2:
+        lines.push_back(indent + "for (std::size_t i = 0; i != " + identifier(random)
+            + ".size(); ++i)");
+        lines.push_back(indent + "{");
+        lines.push_back(indent + "    " + identifier(random) + "[i] += "
+            + expression(random, 2) + ";");
+        lines.push_back(indent + "}");
+        break;
+    case 3:
+        lines.push_back(indent + identifier(random) + "(" + expression(random, 1) + ", "
+            + expression(random, 2) + ");");
+        break;
+    case 4:
+        lines.push_back(indent + "while (" + identifier(random) + " != 0)");
+        lines.push_back(indent + "{");
+        lines.push_back(indent + "    --" + identifier(random) + ";");
+        lines.push_back(indent + "}");
+        break;
+    default:
+        lines.push_back(indent + "std::cout << " + expression(random, 2) + " << std::endl;");
+        break;
+    }
+}
+
+void addMacro(Random & random, LineCollection & lines)
+{
+    const std::string name = "MACRO_" + identifier(random);
+    switch (random.below(3))
+    {
+    case 0:
+        lines.push_back("#define " + name + " " + literal(random));
+        break;
+    case 1:
+        lines.push_back("#define " + name + "(x) \\");
+        lines.push_back("    do { \\");
+        lines.push_back("        x += " + literal(random) + "; \\");
+        lines.push_back("    } while (0)");
+        break;
+    default:
+        lines.push_back("#ifdef " + name);
+        lines.push_back("#undef " + name);
+        lines.push_back("#endif");
+        break;
+    }
+}
+
+void addFunction(Random & random, const Vera::Bench::CorpusOptions & options,
+    std::size_t lineCount, LineCollection & lines)
+{
+    const std::string reference = pick(random, types, countOf(types));
+    lines.push_back(pick(random, types, countOf(types)) + " " + identifier(random) + "("
+        + pick(random, types, countOf(types)) + " " + identifier(random) + ", "
+        + (reference.compare(0, 6, "const ") == 0 ? "" : "const ") + reference + " & "
+        + identifier(random) + ")");
+    lines.push_back("{");
+    const int statements = 3 + random.below(12);
+    for (int i = 0; i != statements && lines.size() + 1 < lineCount; ++i)
+    {
+        addStatement(random, options, "    ", lines);
+    }
+    lines.push_back("}");
+    lines.push_back("");
+}
+
+void addClass(Random & random, LineCollection & lines)
+{
+    lines.push_back("class " + identifier(random));
+    lines.push_back("{");
+    lines.push_back("public:");
+    const int members = 2 + random.below(6);
+    for (int i = 0; i != members; ++i)
+    {
+        lines.push_back("    " + std::string(random.percent(50) ? "virtual " : "")
+            + pick(random, types, countOf(types)) + " " + identifier(random) + "() const;");
+    }
+    lines.push_back("private:");
+    lines.push_back("    " + std::string(pick(random, types, countOf(types))) + " "
+        + identifier(random) + "_;");
+    lines.push_back("};");
+    lines.push_back("");
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Bench
+{
+
+CorpusOptions::CorpusOptions()
+    : files_(100), lines_(500), longLines_(2), macros_(3), comments_(10),
+    crlf_(false), seed_(1)
+{
+}
+
+Corpus::Corpus(const CorpusOptions & options)
+    : options_(options)
+{
+}
+
+const CorpusOptions & Corpus::getOptions() const
+{
+    return options_;
+}
+
+std::string Corpus::generate(int index) const
+{
+    Random random(options_.seed_ * 7919u + static_cast<unsigned int>(index) * 104729u);
+    const std::size_t lineCount = static_cast<std::size_t>(options_.lines_);
+
+    LineCollection lines;
+    lines.push_back("// generated file " + identifier(random));
+    lines.push_back("#include <string>");
+    lines.push_back("#include <vector>");
+    lines.push_back("");
+    lines.push_back("namespace " + identifier(random));
+    lines.push_back("{");
+    while (lines.size() + 1 < lineCount)
+    {
+        if (random.percent(options_.macros_ * 4))
+        {
+            addMacro(random, lines);
+        }
+        else if (random.percent(20))
+        {
+            addClass(random, lines);
+        }
+        else
+        {
+            addFunction(random, options_, lineCount, lines);
+        }
+    }
+    lines.resize(lineCount - 1);
+    lines.push_back("}");
+
+    const char * const newline = options_.crlf_ ? "\r\n" : "\n";
+    std::string res;
+    for (LineCollection::const_iterator it = lines.begin(); it != lines.end(); ++it)
+    {
+        res += *it;
+        res += newline;
+    }
+    return res;
+}
+
+Corpus::FileNameCollection Corpus::write(const std::string & directory) const
+{
+    boost::filesystem::create_directories(directory);
+
+    FileNameCollection names;
+    for (int i = 0; i != options_.files_; ++i)
+    {
+        std::ostringstream ss;
+        ss << directory << "/file" << i << ".cpp";
+        const std::string name = ss.str();
+
+        std::ofstream file(name.c_str(), std::ios::binary);
+        if (file.is_open() == false)
+        {
+            throw std::runtime_error("Cannot open " + name + ": " + strerror(errno));
+        }
+        const std::string content = generate(i);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (file.bad())
+        {
+            throw std::runtime_error("Cannot write to " + name + ": " + strerror(errno));
+        }
+        names.push_back(name);
+    }
+    return names;
+}
+
+}
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef CORPUS_H_INCLUDED
+#define CORPUS_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+
+namespace Vera
+{
+namespace Bench
+{
+
+struct CorpusOptions
+{
+    CorpusOptions();
+
+    int files_;
+    int lines_;
+
+    // in percents of the lines
+    int longLines_;
+    int macros_;
+    int comments_;
+
+    bool crlf_;
+    unsigned int seed_;
+};
+
+// Generates C++ sources with the usual mix of declarations, statements,
+// literals, comments and macros. The files only depend on the options, so
+// the results of different runs can be compared.
+class Corpus
+{
+public:
+    typedef std::vector<std::string> FileNameCollection;
+
+    explicit Corpus(const CorpusOptions & options);
+
+    const CorpusOptions & getOptions() const;
+
+    std::string generate(int index) const;
+
+    // writes the files in the directory, which is created if needed
+    FileNameCollection write(const std::string & directory) const;
+
+private:
+    const CorpusOptions options_;
+};
+
+} // namespace Bench
+
+} // namespace Vera
+
+#endif // CORPUS_H_INCLUDED
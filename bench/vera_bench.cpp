@@ -0,0 +1,426 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "config.h"
+#include "Benchmark.h"
+#include "Corpus.h"
+#include "../src/executable_path.h"
+#include "../src/structures/SourceFiles.h"
+#include "../src/structures/SourceLines.h"
+#include "../src/structures/Tokens.h"
+#include "../src/plugins/Exclusions.h"
+#include "../src/plugins/Reports.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#define foreach BOOST_FOREACH
+
+
+namespace // unnamed
+{
+
+typedef Vera::Structures::SourceFiles::FileId FileId;
+
+// the corpus in memory, shared by the microbenchmarks
+struct Source
+{
+    Vera::Structures::SourceFiles::FileName name_;
+    FileId id_;
+    std::string content_;
+    std::size_t lines_;
+};
+
+typedef std::vector<Source> SourceCollection;
+
+SourceCollection sources;
+std::size_t totalBytes = 0;
+std::size_t totalLines = 0;
+
+void generateSources(const Vera::Bench::Corpus & corpus)
+{
+    for (int i = 0; i != corpus.getOptions().files_; ++i)
+    {
+        std::ostringstream ss;
+        ss << "corpus/file" << i << ".cpp";
+
+        Source source;
+        source.name_ = ss.str();
+        source.id_ = Vera::Structures::SourceFiles::getFileId(source.name_);
+        source.content_ = corpus.generate(i);
+        source.lines_ = static_cast<std::size_t>(corpus.getOptions().lines_);
+        sources.push_back(source);
+
+        totalBytes += source.content_.size();
+        totalLines += source.lines_;
+    }
+}
+
+class LoadFile : public Vera::Bench::Case
+{
+public:
+    LoadFile() : Case("BM_LoadFile") {}
+
+    virtual void setUp()
+    {
+        Vera::Structures::SourceLines::setParseOnLoad(false);
+        setBytes(totalBytes);
+        setItems(totalLines);
+    }
+
+    virtual void run(std::size_t iterations)
+    {
+        for (std::size_t i = 0; i != iterations; ++i)
+        {
+            foreach (const Source & source, sources)
+            {
+                std::istringstream is(source.content_);
+                Vera::Structures::SourceLines::loadFile(is, source.id_);
+            }
+        }
+    }
+};
+
+class Parse : public Vera::Bench::Case
+{
+public:
+    explicit Parse(const Vera::Structures::Tokens::LexerName & lexer)
+        : Case("BM_Parse/" + lexer), lexer_(lexer) {}
+
+    virtual void setUp()
+    {
+        Vera::Structures::Tokens::setLexer(lexer_);
+        setBytes(totalBytes);
+        setItems(totalLines);
+    }
+
+    virtual void run(std::size_t iterations)
+    {
+        for (std::size_t i = 0; i != iterations; ++i)
+        {
+            foreach (const Source & source, sources)
+            {
+                Vera::Structures::Tokens::parse(source.id_, source.content_);
+            }
+        }
+    }
+
+private:
+    const Vera::Structures::Tokens::LexerName lexer_;
+};
+
+class GetTokens : public Vera::Bench::Case
+{
+public:
+    GetTokens(const std::string & name, const Vera::Structures::Tokens::FilterSequence & filter)
+        : Case("BM_GetTokens/" + name), filter_(filter) {}
+
+    virtual void setUp()
+    {
+        Vera::Structures::Tokens::setLexer("fast");
+        std::size_t tokens = 0;
+        foreach (const Source & source, sources)
+        {
+            Vera::Structures::Tokens::parse(source.id_, source.content_);
+            tokens += Vera::Structures::Tokens::getTokens(
+                source.id_, 1, 0, -1, -1, filter_).size();
+        }
+        setItems(tokens);
+    }
+
+    virtual void run(std::size_t iterations)
+    {
+        for (std::size_t i = 0; i != iterations; ++i)
+        {
+            foreach (const Source & source, sources)
+            {
+                Vera::Structures::Tokens::getTokens(source.id_, 1, 0, -1, -1, filter_);
+            }
+        }
+    }
+
+private:
+    const Vera::Structures::Tokens::FilterSequence filter_;
+};
+
+// the reports of a few rules, on all the lines of the files
+class ReportsAdd : public Vera::Bench::Case
+{
+public:
+    ReportsAdd() : Case("BM_ReportsAdd"), line_(0) {}
+
+    virtual void setUp()
+    {
+        setItems(1);
+    }
+
+    virtual void run(std::size_t iterations)
+    {
+        for (std::size_t i = 0; i != iterations; ++i)
+        {
+            const Source & source = sources[i % sources.size()];
+            line_ = line_ % source.lines_ + 1;
+            Vera::Plugins::Reports::add(source.name_, line_, "trailing whitespace");
+        }
+    }
+
+private:
+    int line_;
+};
+
+// a regex per excluded file, and a few on the messages of any rule
+class ExclusionMatch : public Vera::Bench::Case
+{
+public:
+    explicit ExclusionMatch(const std::string & directory)
+        : Case("BM_ExclusionMatch"), directory_(directory) {}
+
+    virtual void setUp()
+    {
+        const std::string fileName = directory_ + "/exclusions.txt";
+        {
+            boost::filesystem::create_directories(directory_);
+            std::ofstream file(fileName.c_str());
+            file << "# generated by vera_bench\n";
+            for (std::size_t i = 0; i < sources.size(); i += 10)
+            {
+                file << "^corpus/file" << i << "\\.cpp:[0-9]+: L00[1-6]: \n";
+                file << "^corpus/file" << i + 1 << "\\.cpp:1[0-9]: T011: \n";
+            }
+            file << ": F002: file name is too long\n";
+            file << "trailing whitespace$\n";
+        }
+        Vera::Plugins::Exclusions::setExclusionsRegex(fileName);
+        setItems(1);
+    }
+
+    virtual void run(std::size_t iterations)
+    {
+        static const char * const rules[] = { "L001", "L003", "T011", "F002", "T019" };
+        static const char * const messages[] =
+        {
+            "trailing whitespace", "line is longer than 100 characters",
+            "closing curly bracket not in the same line or column", "file name is too long",
+            "full block {} expected in the control structure"
+        };
+        int excluded = 0;
+        for (std::size_t i = 0; i != iterations; ++i)
+        {
+            const Source & source = sources[i % sources.size()];
+            const std::size_t kind = i % 5;
+            if (Vera::Plugins::Exclusions::isExcluded(source.name_,
+                    static_cast<int>(i % source.lines_) + 1, rules[kind], messages[kind]))
+            {
+                ++excluded;
+            }
+        }
+        excluded_ = excluded;
+    }
+
+private:
+    const std::string directory_;
+
+    // so that the calls are not optimized away
+    volatile int excluded_;
+};
+
+// vera++ on the corpus written to the disk
+class EndToEnd : public Vera::Bench::Case
+{
+public:
+    EndToEnd(const std::string & vera, const std::string & root, const std::string & corpus)
+        : Case("BM_EndToEnd/full"), vera_(vera), root_(root), corpus_(corpus) {}
+
+    virtual void setUp()
+    {
+        command_ = "\"" + vera_ + "\" --profile full --root \"" + root_ + "\" --quiet";
+        foreach (const std::string & name, Vera::Bench::Corpus(options_).write(corpus_))
+        {
+            command_ += " \"" + name + "\"";
+        }
+        setBytes(totalBytes);
+        setItems(totalLines);
+    }
+
+    virtual void run(std::size_t iterations)
+    {
+        for (std::size_t i = 0; i != iterations; ++i)
+        {
+            const int status = std::system(command_.c_str());
+            if (status != 0)
+            {
+                std::ostringstream ss;
+                ss << "vera++ failed with the status " << status << ": " << command_;
+                throw std::runtime_error(ss.str());
+            }
+        }
+    }
+
+    Vera::Bench::CorpusOptions options_;
+
+private:
+    const std::string vera_;
+    const std::string root_;
+    const std::string corpus_;
+    std::string command_;
+};
+
+template <typename T>
+std::string toString(const T & value)
+{
+    std::ostringstream ss;
+    ss << value;
+    return ss.str();
+}
+
+} // unnamed namespace
+
+int main(int argc, char * argv[])
+{
+    Vera::Bench::CorpusOptions corpusOptions;
+    Vera::Bench::RunnerOptions runnerOptions;
+    std::string generateDirectory;
+    std::string corpusDirectory = "vera_bench_corpus";
+    std::string outFile;
+    // in the build tree, the benchmarks are built next to the src directory
+    std::string vera = (boost::filesystem::path(executable_path(argv[0])).parent_path()
+        / ".." / "src" / "vera++").string();
+    std::string root = VERA_SOURCE_DIR;
+    bool endToEnd = true;
+
+    namespace po = boost::program_options;
+    po::options_description options("Options");
+    options.add_options()
+        ("files", po::value(&corpusOptions.files_), "the number of files of the corpus")
+        ("lines", po::value(&corpusOptions.lines_), "the number of lines of each file")
+        ("long-lines", po::value(&corpusOptions.longLines_),
+            "the percentage of statements written as lines of a few hundred characters")
+        ("macros", po::value(&corpusOptions.macros_),
+            "the percentage of the declarations that are preprocessor directives")
+        ("comments", po::value(&corpusOptions.comments_),
+            "the percentage of statements that are comments")
+        ("crlf", "end the lines with CR LF")
+        ("seed", po::value(&corpusOptions.seed_), "the seed of the corpus")
+        ("generate", po::value(&generateDirectory),
+            "only write the corpus to this directory")
+        ("repetitions", po::value(&runnerOptions.repetitions_),
+            "the number of measures of each benchmark, to compute the median")
+        ("min-time", po::value(&runnerOptions.minTime_),
+            "the minimum time of a measure, in seconds")
+        ("filter", po::value(&runnerOptions.filter_),
+            "only run the benchmarks whose name matches this regex")
+        ("out", po::value(&outFile), "write the results as JSON to this file (- for stdout)")
+        ("vera", po::value(&vera), "the vera++ executable of the end-to-end benchmark")
+        ("root", po::value(&root), "the root directory of the end-to-end benchmark")
+        ("corpus-dir", po::value(&corpusDirectory),
+            "the directory where the corpus of the end-to-end benchmark is written")
+        ("no-end-to-end", "don't run the end-to-end benchmark")
+        ("help,h", "show this help message and exit");
+
+    try
+    {
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(options).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << "vera_bench [options]\n\n" << options << std::endl;
+            return EXIT_SUCCESS;
+        }
+        corpusOptions.crlf_ = vm.count("crlf") != 0;
+        endToEnd = vm.count("no-end-to-end") == 0;
+
+        if (corpusOptions.files_ <= 0 || corpusOptions.lines_ <= 0)
+        {
+            std::cerr << "vera_bench: the corpus needs at least one file and one line"
+                << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const Vera::Bench::Corpus corpus(corpusOptions);
+        if (generateDirectory.empty() == false)
+        {
+            corpus.write(generateDirectory);
+            return EXIT_SUCCESS;
+        }
+
+        generateSources(corpus);
+
+        Vera::Bench::Runner runner(runnerOptions);
+        runner.add(boost::make_shared<LoadFile>());
+        runner.add(boost::make_shared<Parse>("fast"));
+        runner.add(boost::make_shared<Parse>("wave"));
+
+        Vera::Structures::Tokens::FilterSequence filter;
+        runner.add(boost::make_shared<GetTokens>("all", filter));
+        filter.push_back("identifier");
+        runner.add(boost::make_shared<GetTokens>("identifier", filter));
+        filter.clear();
+        filter.push_back("leftbrace");
+        filter.push_back("rightbrace");
+        filter.push_back("semicolon");
+        runner.add(boost::make_shared<GetTokens>("braces", filter));
+
+        runner.add(boost::make_shared<ReportsAdd>());
+        runner.add(boost::make_shared<ExclusionMatch>(corpusDirectory));
+        if (endToEnd)
+        {
+            boost::shared_ptr<EndToEnd> full =
+                boost::make_shared<EndToEnd>(vera, root, corpusDirectory);
+            full->options_ = corpusOptions;
+            runner.add(full);
+        }
+
+        runner.run(std::cerr);
+
+        if (outFile.empty() == false)
+        {
+            Vera::Bench::Runner::Context context;
+            context.push_back(std::make_pair("date", boost::posix_time::to_iso_extended_string(
+                boost::posix_time::second_clock::universal_time())));
+            context.push_back(std::make_pair("version", std::string(VERA_VERSION)));
+            context.push_back(std::make_pair("files", toString(corpusOptions.files_)));
+            context.push_back(std::make_pair("lines", toString(corpusOptions.lines_)));
+            context.push_back(std::make_pair("long_lines", toString(corpusOptions.longLines_)));
+            context.push_back(std::make_pair("macros", toString(corpusOptions.macros_)));
+            context.push_back(std::make_pair("comments", toString(corpusOptions.comments_)));
+            context.push_back(std::make_pair("crlf", corpusOptions.crlf_ ? "true" : "false"));
+            context.push_back(std::make_pair("seed", toString(corpusOptions.seed_)));
+            context.push_back(std::make_pair("bytes", toString(totalBytes)));
+            context.push_back(std::make_pair("repetitions",
+                toString(runnerOptions.repetitions_)));
+
+            if (outFile == "-")
+            {
+                runner.writeJson(std::cout, context);
+            }
+            else
+            {
+                std::ofstream file(outFile.c_str());
+                if (file.is_open() == false)
+                {
+                    std::cerr << "vera_bench: cannot open " << outFile << std::endl;
+                    return EXIT_FAILURE;
+                }
+                runner.writeJson(file, context);
+            }
+        }
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << "vera_bench: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
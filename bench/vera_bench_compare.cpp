@@ -0,0 +1,248 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/program_options.hpp>
+#include <boost/regex.hpp>
+#include <boost/foreach.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define foreach BOOST_FOREACH
+
+
+namespace // unnamed
+{
+
+typedef std::vector<double> TimeCollection;
+
+// the repetition times of a benchmark, sorted, in nanoseconds per iteration
+typedef std::map<std::string, TimeCollection> BenchmarkMap;
+
+BenchmarkMap readBenchmarks(const std::string & fileName)
+{
+    boost::property_tree::ptree tree;
+    boost::property_tree::read_json(fileName, tree);
+
+    BenchmarkMap res;
+    foreach (const boost::property_tree::ptree::value_type & benchmark,
+        tree.get_child("benchmarks"))
+    {
+        TimeCollection & times = res[benchmark.second.get<std::string>("name")];
+        foreach (const boost::property_tree::ptree::value_type & time,
+            benchmark.second.get_child("times"))
+        {
+            times.push_back(time.second.get_value<double>());
+        }
+        if (times.empty())
+        {
+            throw std::runtime_error("no times for the benchmark "
+                + benchmark.second.get<std::string>("name") + " in " + fileName);
+        }
+        std::sort(times.begin(), times.end());
+    }
+    return res;
+}
+
+double median(const TimeCollection & times)
+{
+    const std::size_t size = times.size();
+    return size % 2 == 1 ? times[size / 2] : (times[size / 2 - 1] + times[size / 2]) / 2;
+}
+
+struct Interval
+{
+    double low_;
+    double high_;
+};
+
+// The interval between two order statistics contains the median with a
+// probability given by the binomial distribution, whatever the distribution of
+// the times. The narrowest one with the given confidence is used, or all the
+// times when there are too few of them.
+Interval medianInterval(const TimeCollection & times, double confidence)
+{
+    const std::size_t size = times.size();
+
+    // the probabilities of i times under the median, for i = 0 .. size
+    std::vector<double> probabilities(size + 1);
+    double binomial = 1;
+    for (std::size_t i = 0; i <= size; ++i)
+    {
+        probabilities[i] = binomial * std::pow(0.5, static_cast<double>(size));
+        binomial = binomial * (size - i) / (i + 1);
+    }
+
+    std::size_t k = 1;
+    double tail = probabilities[0];
+    while (k < (size + 1) / 2 && 1 - 2 * (tail + probabilities[k]) >= confidence)
+    {
+        tail += probabilities[k];
+        ++k;
+    }
+
+    Interval res;
+    res.low_ = times[k - 1];
+    res.high_ = times[size - k];
+    return res;
+}
+
+std::string formatInterval(const Interval & interval)
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(0) << '[' << interval.low_ << ", "
+        << interval.high_ << ']';
+    return ss.str();
+}
+
+} // unnamed namespace
+
+int main(int argc, char * argv[])
+{
+    std::string baselineFile;
+    std::string contenderFile;
+    double threshold = 5;
+    double confidence = 0.95;
+    std::string gate = "^BM_(Parse|GetTokens|EndToEnd)/";
+
+    namespace po = boost::program_options;
+    po::options_description visibleOptions("Options");
+    visibleOptions.add_options()
+        ("threshold", po::value(&threshold), "the loss of throughput, in percents, over which"
+            " a benchmark fails (5 by default)")
+        ("confidence", po::value(&confidence), "the confidence of the intervals of the medians"
+            " (0.95 by default)")
+        ("gate", po::value(&gate), "the regex of the benchmarks that can fail: the lexing,"
+            " the token queries and the runs of the full profile by default")
+        ("help,h", "show this help message and exit");
+    po::options_description hiddenOptions;
+    hiddenOptions.add_options()
+        ("baseline", po::value(&baselineFile))
+        ("contender", po::value(&contenderFile));
+    po::options_description allOptions;
+    allOptions.add(visibleOptions).add(hiddenOptions);
+    po::positional_options_description positionalOptions;
+    positionalOptions.add("baseline", 1).add("contender", 1);
+
+    try
+    {
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(allOptions)
+            .positional(positionalOptions).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help") || vm.count("contender") == 0)
+        {
+            std::cout << "vera_bench_compare [options] baseline.json contender.json\n\n"
+                << visibleOptions << std::endl;
+            return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        const boost::regex gateRegex(gate);
+        const BenchmarkMap baseline = readBenchmarks(baselineFile);
+        const BenchmarkMap contender = readBenchmarks(contenderFile);
+
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right
+            << std::setw(14) << "baseline" << std::setw(30) << "interval"
+            << std::setw(14) << "contender" << std::setw(30) << "interval"
+            << std::setw(10) << "change" << "  verdict\n";
+
+        int regressions = 0;
+        int missing = 0;
+        for (BenchmarkMap::const_iterator it = baseline.begin(); it != baseline.end(); ++it)
+        {
+            std::cout << std::left << std::setw(28) << it->first << std::right << std::fixed;
+
+            const BenchmarkMap::const_iterator cit = contender.find(it->first);
+            if (cit == contender.end())
+            {
+                // a gated benchmark that is not measured anymore cannot pass the gate
+                if (boost::regex_search(it->first, gateRegex))
+                {
+                    std::cout << "  MISSING\n";
+                    ++missing;
+                }
+                else
+                {
+                    std::cout << "  missing\n";
+                }
+                continue;
+            }
+
+            const double baselineMedian = median(it->second);
+            const double contenderMedian = median(cit->second);
+            const Interval baselineInterval = medianInterval(it->second, confidence);
+            const Interval contenderInterval = medianInterval(cit->second, confidence);
+
+            // of the throughput, in percents
+            const double change = contenderMedian > 0
+                ? (baselineMedian / contenderMedian - 1) * 100 : 0;
+
+            std::string verdict;
+            if (contenderInterval.low_ <= baselineInterval.high_
+                && baselineInterval.low_ <= contenderInterval.high_)
+            {
+                verdict = "same";
+            }
+            else if (change >= 0)
+            {
+                verdict = "faster";
+            }
+            else if (-change > threshold && boost::regex_search(it->first, gateRegex))
+            {
+                verdict = "REGRESSION";
+                ++regressions;
+            }
+            else
+            {
+                verdict = "slower";
+            }
+
+            std::cout << std::setprecision(0) << std::setw(14) << baselineMedian
+                << std::setw(30) << formatInterval(baselineInterval)
+                << std::setw(14) << contenderMedian
+                << std::setw(30) << formatInterval(contenderInterval)
+                << std::setprecision(1) << std::setw(9) << std::showpos << change
+                << std::noshowpos << "%  " << verdict << '\n';
+        }
+        for (BenchmarkMap::const_iterator it = contender.begin(); it != contender.end(); ++it)
+        {
+            if (baseline.find(it->first) == baseline.end())
+            {
+                std::cout << std::left << std::setw(28) << it->first << std::right << "  new\n";
+            }
+        }
+
+        if (regressions != 0)
+        {
+            std::cout << regressions << " benchmarks lost more than " << threshold
+                << "% of their throughput." << std::endl;
+        }
+        if (missing != 0)
+        {
+            std::cout << missing << " gated benchmarks are missing from the contender." << std::endl;
+        }
+        if (regressions != 0 || missing != 0)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << "vera_bench_compare: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -15,10 +15,19 @@ function(vera_add_test_stdin_file name input output error retcode)
   string(REPLACE "\"" "\\\"" protected_output "${protected_output}")
   string(REPLACE "\\" "\\\\" protected_error "${error}")
   string(REPLACE "\"" "\\\"" protected_error "${protected_error}")
+  if(VERA_TEST_ERROR_REGEX)
+    # for the outputs that depend on the machine, as the times
+    set(error_compare MATCHES)
+  else()
+    set(error_compare STREQUAL)
+  endif()
   configure_file(${VERA_TEST_WRAPPER_CMAKE}
     ${CMAKE_CURRENT_BINARY_DIR}/${name}.cmake @ONLY)
 
-  if(NOT VERA++_EXECUTABLE AND TARGET vera)
+  if(VERA_TEST_PROGRAM)
+    # another program of the project
+    set(vera_program "${VERA_TEST_PROGRAM}")
+  elseif(NOT VERA++_EXECUTABLE AND TARGET vera)
     set(vera_program "$<TARGET_FILE:vera>")
   else()
     set(vera_program "${VERA++_EXECUTABLE}")
@@ -104,7 +113,10 @@ function(add_vera_targets)
   endif()
   list(SORT srcs)
 
-  if(NOT VERA++_EXECUTABLE AND TARGET vera)
+  if(VERA_TEST_PROGRAM)
+    # another program of the project
+    set(vera_program "${VERA_TEST_PROGRAM}")
+  elseif(NOT VERA++_EXECUTABLE AND TARGET vera)
     set(vera_program "$<TARGET_FILE:vera>")
   else()
     set(vera_program "${VERA++_EXECUTABLE}")
@@ -1,4 +1,6 @@
 #!/usr/bin/tclsh
+# needs: tokens
+# scope: file
 foreach f [getSourceFileNames] {
     puts "Tokens in file ${f}:"
     foreach t [getTokens $f 1 0 -1 -1 {}] {
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Source files should not use the '\r' (CR) character
+# needs: names
+# scope: file
 
 foreach fileName [getSourceFileNames] {
     if { $fileName == "-" } {
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # File names should be well-formed
+# needs: names
+# scope: file
 
 set maxDirectoryDepth [getParameter "max-directory-depth" 8]
 set maxDirnameLength [getParameter "max-dirname-length" 31]
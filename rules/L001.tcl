@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # No trailing whitespace
+# needs: lines
+# scope: file
 
 set strictMode [getParameter "strict-trailing-space" 0]
 
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Don't use tab characters
+# needs: lines
+# scope: file
 
 foreach f [getSourceFileNames] {
     set lineNumber 1
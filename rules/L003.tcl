@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # No leading and no trailing empty lines
+# needs: lines
+# scope: file
 
 foreach f [getSourceFileNames] {
     set lineCount [getLineCount $f]
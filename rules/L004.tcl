@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Line cannot be too long
+# needs: lines
+# scope: file
 
 set maxLength [getParameter "max-line-length" 100]
 
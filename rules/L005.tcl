@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # There should not be too many consecutive empty lines
+# needs: lines
+# scope: file
 
 set maxEmptyLines [getParameter "max-consecutive-empty-lines" 2]
 
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Source file should not be too long
+# needs: lines
+# scope: file
 
 set maxLines [getParameter "max-file-length" 2000]
 
@@ -15,6 +15,8 @@
 #                                           these probably belong to a package not owned by
 #                                           this project anyway.
 #
+# needs: tokens
+# scope: all
 
 # States:
 #   Ignore lines with pre-processor macros
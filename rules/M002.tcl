@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Check that Type identifiers have an initial uppercase letter.
+# needs: tokens
+# scope: all
 
 # namespace TypeName
 # class TypeName
@@ -1,6 +1,8 @@
 #!/usr/bin/tclsh
 # using namespace XXX is not allowed
 #   Unless you are in the source file X.cpp and the header file X.h contains the namespace XXX.
+# needs: tokens
+# scope: all
 
 proc getHeaderFile {fileName} {
     return [join [list [file rootname $fileName] ".h"] ""]
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # One-line comments should not have forced continuation
+# needs: lines tokens
+# scope: file
 
 foreach f [getSourceFileNames] {
     foreach t [getTokens $f 1 0 -1 -1 {cppcomment}] {
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Reserved names should not be used for preprocessor macros
+# needs: lines tokens
+# scope: file
 
 set keywords {
     asm
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Some keywords should be followed by a single space
+# needs: tokens
+# scope: file
 
 set keywords {
     case
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Some keywords should be immediately followed by a colon
+# needs: tokens
+# scope: file
 
 set keywords {
     default
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Keywords break and continue should be immediately followed by a semicolon
+# needs: tokens
+# scope: file
 
 foreach f [getSourceFileNames] {
     foreach t [getTokens $f 1 0 -1 -1 {break continue}] {
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Keywords return and throw should be immediately followed by a semicolon or a single space
+# needs: tokens
+# scope: file
 
 foreach f [getSourceFileNames] {
     foreach t [getTokens $f 1 0 -1 -1 {return throw delete}] {
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Semicolons should not be isolated by spaces or comments from the rest of the code
+# needs: tokens
+# scope: file
 
 foreach f [getSourceFileNames] {
     foreach t [getTokens $f 1 0 -1 -1 {semicolon}] {
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Keywords if should be followed by a single space
+# needs: tokens
+# scope: file
 
 foreach f [getSourceFileNames] {
     set pp_line -1
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Comma should not be preceded by whitespace, but should be followed by one
+# needs: tokens
+# scope: file
 
 foreach f [getSourceFileNames] {
     foreach t [getTokens $f 1 0 -1 -1 {comma}] {
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Identifiers should not be composed of 'l' and 'O' characters only
+# needs: tokens
+# scope: file
 
 foreach file [getSourceFileNames] {
     foreach t [getTokens $file 1 0 -1 -1 {identifier}] {
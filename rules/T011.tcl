@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Curly brackets from the same pair should be either in the same line or in the same column
+# needs: lines tokens
+# scope: file
 
 proc acceptPairs {} {
     global file parens index end
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Negation operator should not be used in its short form
+# needs: tokens
+# scope: file
 
 foreach file [getSourceFileNames] {
     foreach negation [getTokens $file 1 0 -1 -1 {not}] {
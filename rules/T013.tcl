@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Source files should contain the copyright notice
+# needs: tokens
+# scope: file
 
 foreach file [getSourceFileNames] {
     set found false
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Source files should refer the Boost Software License
+# needs: tokens
+# scope: file
 
 foreach file [getSourceFileNames] {
     set found false
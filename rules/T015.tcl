@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # HTML links in comments and string literals should be correct
+# needs: tokens
+# scope: file
 
 set urlRe {<[[:space:]]*[^>]*[[:space:]]+(?:HREF|SRC)[[:space:]]*=[[:space:]]*\"([^\"]*)\"}
 
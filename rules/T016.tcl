@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Calls to min/max should be protected against accidental macro substitution
+# needs: lines tokens
+# scope: file
 
 foreach file [getSourceFileNames] {
     set prev "none"
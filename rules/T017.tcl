@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # Unnamed namespaces are not allowed in header files
+# needs: tokens
+# scope: file
 
 foreach fileName [getSourceFileNames] {
     set extension [file extension $fileName]
@@ -1,5 +1,7 @@
 #!/usr/bin/tclsh
 # control structures should have complete curly-braced block of code
+# needs: tokens
+# scope: file
 
 foreach fileName [getSourceFileNames] {
 
@@ -0,0 +1,211 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "Session.h"
+#include "structures/SourceFiles.h"
+#include "structures/SourceLines.h"
+#include "structures/Tokens.h"
+#include "plugins/Baseline.h"
+#include "plugins/CallStats.h"
+#include "plugins/Exclusions.h"
+#include "plugins/Parameters.h"
+#include "plugins/Profiler.h"
+#include "plugins/Profiles.h"
+#include "plugins/RootDirectory.h"
+#include "plugins/Rules.h"
+#include "plugins/ScriptCatalog.h"
+#include "plugins/Trace.h"
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+
+namespace // unnamed
+{
+
+// held while the data of a session is in the engine
+boost::mutex engineMutex;
+
+} // unnamed namespace
+
+namespace Vera
+{
+
+struct Session::States
+{
+    States()
+        : sourceFiles_(Structures::SourceFiles::createState()),
+        sourceLines_(Structures::SourceLines::createState()),
+        tokens_(Structures::Tokens::createState()),
+        baseline_(Plugins::Baseline::createState()),
+        callStats_(Plugins::CallStats::createState()),
+        exclusions_(Plugins::Exclusions::createState()),
+        parameters_(Plugins::Parameters::createState()),
+        profiler_(Plugins::Profiler::createState()),
+        reports_(Plugins::Reports::createState()),
+        rootDirectory_(Plugins::RootDirectory::createState()),
+        rules_(Plugins::Rules::createState()),
+        trace_(Plugins::Trace::createState()) {}
+
+    void swap()
+    {
+        Structures::SourceFiles::swapState(*sourceFiles_);
+        Structures::SourceLines::swapState(*sourceLines_);
+        Structures::Tokens::swapState(*tokens_);
+        Plugins::Baseline::swapState(*baseline_);
+        Plugins::CallStats::swapState(*callStats_);
+        Plugins::Exclusions::swapState(*exclusions_);
+        Plugins::Parameters::swapState(*parameters_);
+        Plugins::Profiler::swapState(*profiler_);
+        Plugins::Reports::swapState(*reports_);
+        Plugins::RootDirectory::swapState(*rootDirectory_);
+        Plugins::Rules::swapState(*rules_);
+        Plugins::Trace::swapState(*trace_);
+    }
+
+    boost::shared_ptr<Structures::SourceFiles::State> sourceFiles_;
+    boost::shared_ptr<Structures::SourceLines::State> sourceLines_;
+    boost::shared_ptr<Structures::Tokens::State> tokens_;
+    boost::shared_ptr<Plugins::Baseline::State> baseline_;
+    boost::shared_ptr<Plugins::CallStats::State> callStats_;
+    boost::shared_ptr<Plugins::Exclusions::State> exclusions_;
+    boost::shared_ptr<Plugins::Parameters::State> parameters_;
+    boost::shared_ptr<Plugins::Profiler::State> profiler_;
+    boost::shared_ptr<Plugins::Reports::State> reports_;
+    boost::shared_ptr<Plugins::RootDirectory::State> rootDirectory_;
+    boost::shared_ptr<Plugins::Rules::State> rules_;
+    boost::shared_ptr<Plugins::Trace::State> trace_;
+};
+
+// Puts the data of the session in the engine for its lifetime. The swaps
+// don't throw, so the data of the engine is always restored, even when the
+// call fails.
+class Session::Use : private boost::noncopyable
+{
+public:
+    explicit Use(Session & session)
+        : lock_(engineMutex), states_(*session.states_)
+    {
+        states_.swap();
+    }
+
+    ~Use()
+    {
+        states_.swap();
+    }
+
+private:
+    boost::lock_guard<boost::mutex> lock_;
+    States & states_;
+};
+
+Session::Session()
+    : states_(new States())
+{
+}
+
+Session::~Session()
+{
+}
+
+void Session::setRootDirectory(const DirectoryName & name)
+{
+    Use use(*this);
+    Plugins::RootDirectory::setRootDirectory(name);
+}
+
+void Session::setParameter(const std::string & name, const std::string & value)
+{
+    Use use(*this);
+    Plugins::Parameters::set(name + "=" + value);
+}
+
+void Session::readParameters(const FileName & name)
+{
+    Use use(*this);
+    Plugins::Parameters::readFromFile(name);
+}
+
+void Session::readExclusions(const FileName & name)
+{
+    Use use(*this);
+    Plugins::Exclusions::setExclusions(name);
+}
+
+void Session::readBaseline(const FileName & name)
+{
+    Use use(*this);
+    Plugins::Baseline::load(name);
+}
+
+void Session::setLexer(const std::string & name)
+{
+    Use use(*this);
+    Structures::Tokens::setLexer(name);
+}
+
+void Session::setMaxMemory(std::size_t bytes)
+{
+    Use use(*this);
+    Structures::SourceLines::setMaxMemory(bytes);
+}
+
+void Session::addFile(const FileName & name)
+{
+    Use use(*this);
+    Structures::SourceFiles::addFileName(name);
+}
+
+void Session::addBuffers(const BufferCollection & buffers)
+{
+    Use use(*this);
+    Structures::SourceLines::loadBuffers(buffers);
+}
+
+int Session::countFiles()
+{
+    Use use(*this);
+    return Structures::SourceFiles::count();
+}
+
+void Session::executeRule(const RuleName & name)
+{
+    Use use(*this);
+    Plugins::Rules::executeRules(Plugins::Rules::RuleNameCollection(1, name));
+}
+
+void Session::executeProfile(const ProfileName & name)
+{
+    Use use(*this);
+    Plugins::Profiles::executeProfile(name);
+}
+
+int Session::countReports()
+{
+    Use use(*this);
+    return Plugins::Reports::count();
+}
+
+Session::ReportCollection Session::getReports(bool omitDuplicates)
+{
+    Use use(*this);
+    return Plugins::Reports::getAll(omitDuplicates);
+}
+
+void Session::writeReports(const Plugins::Reports::OutputCollection & outputs,
+    bool omitDuplicates)
+{
+    Use use(*this);
+    Plugins::Reports::write(outputs, omitDuplicates);
+}
+
+void Session::setHotReload(bool reload)
+{
+    boost::lock_guard<boost::mutex> lock(engineMutex);
+    Plugins::ScriptCatalog::setHotReload(reload);
+}
+
+}
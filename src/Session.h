@@ -0,0 +1,87 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef SESSION_H_INCLUDED
+#define SESSION_H_INCLUDED
+
+#include "structures/SourceLines.h"
+#include "plugins/Reports.h"
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+
+namespace Vera
+{
+
+// A check run through the library. The session owns its source files, its
+// parameters, its exclusions, its baseline, its reports and its diagnostics
+// (the profiler, the trace and the call statistics), so any number of
+// sessions can live in the same process and be used from any thread.
+//
+// The sessions are serialized: the engine works on the data of one session
+// at a time, and each call lends the data of the session to the engine under
+// a process wide lock, and takes it back before returning. The calls of two
+// threads on two sessions therefore run one after the other, not at the same
+// time. Only the catalog of the scripts is shared by the sessions, as a cache
+// of the scripts on the disk (see setHotReload).
+class Session : private boost::noncopyable
+{
+public:
+    typedef std::string FileName;
+    typedef std::string DirectoryName;
+    typedef std::string RuleName;
+    typedef std::string ProfileName;
+    typedef Plugins::Reports::Record Report;
+    typedef Plugins::Reports::RecordCollection ReportCollection;
+    typedef Structures::SourceLines::Buffer Buffer;
+    typedef Structures::SourceLines::BufferCollection BufferCollection;
+
+    Session();
+    ~Session();
+
+    // where the rules and the profiles are found
+    void setRootDirectory(const DirectoryName & name);
+
+    void setParameter(const std::string & name, const std::string & value);
+    void readParameters(const FileName & name);
+    void readExclusions(const FileName & name);
+    void readBaseline(const FileName & name);
+    void setLexer(const std::string & name);
+    void setMaxMemory(std::size_t bytes);
+
+    void addFile(const FileName & name);
+
+    // files given with their content, which are never read from the disk
+    void addBuffers(const BufferCollection & buffers);
+
+    int countFiles();
+
+    // a rule can be followed by the data it needs, as in a profile
+    void executeRule(const RuleName & name);
+    void executeProfile(const ProfileName & name);
+
+    int countReports();
+
+    // sorted by file name then line number
+    ReportCollection getReports(bool omitDuplicates);
+    void writeReports(const Plugins::Reports::OutputCollection & outputs, bool omitDuplicates);
+
+    // For all the sessions, off by default: the scripts modified on the disk
+    // are read again on their next use, instead of the ones of the first scan.
+    static void setHotReload(bool reload);
+
+private:
+    struct States;
+    class Use;
+
+    boost::shared_ptr<States> states_;
+};
+
+} // namespace Vera
+
+#endif // SESSION_H_INCLUDED
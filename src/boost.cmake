@@ -6,7 +6,7 @@ else()
 endif()
 mark_as_advanced(VERA_USE_SYSTEM_BOOST)
 
-set(boostLibs filesystem system program_options regex wave)
+set(boostLibs filesystem system program_options regex wave thread)
 if(VERA_PYTHON)
   # Note that Boost Python components require a Python version
   # suffix (Boost 1.67 and later), e.g. python36 or python27 for
@@ -7,23 +7,33 @@
 
 #include "config.h"
 #include "structures/SourceFiles.h"
+#include "structures/SourceLines.h"
+#include "structures/SourceTree.h"
+#include "structures/Tokens.h"
 #include "plugins/Profiles.h"
 #include "plugins/Rules.h"
 #include "plugins/Exclusions.h"
+#include "plugins/Baseline.h"
+#include "plugins/CallStats.h"
 #include "plugins/Transformations.h"
 #include "plugins/Parameters.h"
+#include "plugins/Profiler.h"
+#include "plugins/Trace.h"
 #include "plugins/Reports.h"
 #include "plugins/RootDirectory.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
+#include <utility>
 #include <cstdlib>
 #include <sys/stat.h>
 #include <cstring>
 #include <cerrno>
 #include <boost/program_options.hpp>
 #include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
 #include "get_vera_root_default.h"
 
 #define foreach BOOST_FOREACH
@@ -33,8 +43,12 @@
 #pragma warning(disable:4800)
 #endif
 
-template<typename Files, typename Options, typename Reporter>
-void doReports(Files & reports, Options & vm, Reporter * reporter)
+typedef boost::shared_ptr<std::ofstream> OutputFilePtr;
+typedef std::vector<std::pair<std::string, OutputFilePtr> > OutputFileCollection;
+
+template<typename Files, typename Options>
+void addReports(Files & reports, Options & vm, Vera::Plugins::Reports::Format format,
+    Vera::Plugins::Reports::OutputCollection & outputs, OutputFileCollection & files)
 {
     foreach (const std::string & fn, reports)
     {
@@ -42,31 +56,188 @@ void doReports(Files & reports, Options & vm, Reporter * reporter)
         {
             if (vm.count("warning") || vm.count("error"))
             {
-                (*reporter)(std::cerr, vm.count("no-duplicate"));
+                outputs.push_back(Vera::Plugins::Reports::Output(format, std::cerr));
             }
             else
             {
-              (*reporter)(std::cout, vm.count("no-duplicate"));
+                outputs.push_back(Vera::Plugins::Reports::Output(format, std::cout));
             }
         }
         else
         {
-            std::ofstream file(fn.c_str());
-            if (file.is_open() == false)
+            OutputFilePtr file(new std::ofstream(fn.c_str()));
+            if (file->is_open() == false)
             {
                 throw std::runtime_error(
                     "Cannot open " + fn + ": " + strerror(errno));
             }
-            (*reporter)(file, vm.count("no-duplicate"));
-            if (file.bad())
-            {
-                throw std::runtime_error(
-                    "Cannot write to " + fn + ": " + strerror(errno));
-            }
-            file.close();
+            files.push_back(std::make_pair(fn, file));
+            outputs.push_back(Vera::Plugins::Reports::Output(format, *file));
         }
     }
+}
+
+template<typename Options>
+void doReports(Options & vm, const std::vector<std::string> & stdreports,
+    const std::vector<std::string> & vcreports, const std::vector<std::string> & xmlreports,
+    const std::vector<std::string> & checkstylereports,
+    const std::vector<std::string> & sarifreports,
+    const std::vector<std::string> & jsonlreports)
+{
+    // all the reports are written in a single pass over the collected messages
+    Vera::Plugins::Reports::OutputCollection outputs;
+    OutputFileCollection files;
+    addReports(stdreports, vm, Vera::Plugins::Reports::standard, outputs, files);
+    addReports(vcreports, vm, Vera::Plugins::Reports::visualc, outputs, files);
+    addReports(xmlreports, vm, Vera::Plugins::Reports::xml, outputs, files);
+    addReports(checkstylereports, vm, Vera::Plugins::Reports::checkstyle, outputs, files);
+    addReports(sarifreports, vm, Vera::Plugins::Reports::sarif, outputs, files);
+    addReports(jsonlreports, vm, Vera::Plugins::Reports::jsonlines, outputs, files);
 
+    Vera::Plugins::Reports::write(outputs, vm.count("no-duplicate"));
+
+    foreach (const OutputFileCollection::value_type & f, files)
+    {
+        if (f.second->bad())
+        {
+            throw std::runtime_error(
+                "Cannot write to " + f.first + ": " + strerror(errno));
+        }
+        f.second->close();
+    }
+}
+
+// the table on the standard error, and the JSON in the file
+void writeProfileReport(const std::string & fileName)
+{
+    Vera::Plugins::Profiler::writeTable(std::cerr);
+
+    std::ofstream file(fileName.c_str());
+    if (file.is_open() == false)
+    {
+        throw std::runtime_error(
+            "Cannot open " + fileName + ": " + strerror(errno));
+    }
+    Vera::Plugins::Profiler::writeJson(file);
+    if (file.bad())
+    {
+        throw std::runtime_error(
+            "Cannot write to " + fileName + ": " + strerror(errno));
+    }
+}
+
+// - for the standard output
+void writeOutput(const std::string & fileName, void (*write)(std::ostream &),
+    std::ios_base::openmode mode = std::ios_base::out)
+{
+    if (fileName == "-")
+    {
+        write(std::cout);
+        return;
+    }
+
+    std::ofstream file(fileName.c_str(), mode);
+    if (file.is_open() == false)
+    {
+        throw std::runtime_error(
+            "Cannot open " + fileName + ": " + strerror(errno));
+    }
+    write(file);
+    if (file.bad())
+    {
+        throw std::runtime_error(
+            "Cannot write to " + fileName + ": " + strerror(errno));
+    }
+}
+
+// in bytes, from megabytes or a size with a K, M or G suffix
+std::size_t parseMemorySize(const std::string & size)
+{
+    std::size_t value = 0;
+    std::string::size_type i = 0;
+    for ( ; i != size.size() && size[i] >= '0' && size[i] <= '9'; ++i)
+    {
+        value = value * 10 + static_cast<std::size_t>(size[i] - '0');
+    }
+    const std::string suffix = size.substr(i);
+    if (i == 0 || suffix.size() > 1)
+    {
+        throw std::runtime_error("invalid memory size: " + size);
+    }
+    else if (suffix == "K" || suffix == "k")
+    {
+        return value * 1024;
+    }
+    else if (suffix == "G" || suffix == "g")
+    {
+        return value * 1024 * 1024 * 1024;
+    }
+    else if (suffix.empty() || suffix == "M" || suffix == "m")
+    {
+        return value * 1024 * 1024;
+    }
+    throw std::runtime_error("invalid memory size: " + size);
+}
+
+// i/N, with i from 1 to N
+void setShard(const std::string & shard)
+{
+    std::istringstream ss(shard);
+    int index = 0;
+    int count = 0;
+    char slash = '\0';
+    ss >> index >> slash >> count;
+    std::string rest;
+    if (ss.fail() || slash != '/' || (ss >> rest).fail() == false)
+    {
+        throw std::runtime_error("invalid shard: " + shard);
+    }
+    Vera::Structures::SourceFiles::setShard(index, count);
+}
+
+std::string readBytes(std::istream & is, std::size_t length)
+{
+    std::string bytes(length, '\0');
+    if (length != 0)
+    {
+        is.read(&bytes[0], static_cast<std::streamsize>(length));
+    }
+    if (static_cast<std::size_t>(is.gcount()) != length && length != 0)
+    {
+        throw std::runtime_error("truncated buffer on the standard input");
+    }
+    return bytes;
+}
+
+// Each buffer is given by a line with the length of its name and the length
+// of its content, in bytes, followed by the name and the content.
+Vera::Structures::SourceLines::BufferCollection readBuffers(std::istream & is)
+{
+    Vera::Structures::SourceLines::BufferCollection buffers;
+    std::string header;
+    while (std::getline(is, header))
+    {
+        std::istringstream ss(header);
+        std::size_t nameLength = 0;
+        std::size_t contentLength = 0;
+        ss >> nameLength >> contentLength;
+        const bool valid = ss.fail() == false && nameLength != 0;
+        std::string rest;
+        if (valid == false || (ss >> rest).fail() == false)
+        {
+            throw std::runtime_error("invalid buffer header on the standard input: " + header);
+        }
+        Vera::Structures::SourceLines::Buffer buffer;
+        buffer.name_ = readBytes(is, nameLength);
+        buffer.content_ = readBytes(is, contentLength);
+        buffers.push_back(buffer);
+    }
+    if (is.bad())
+    {
+        throw std::runtime_error(
+            std::string("Cannot read from the standard input: ") + strerror(errno));
+    }
+    return buffers;
 }
 
 int boost_main(int argc, char * argv[])
@@ -128,11 +299,23 @@ int boost_main(int argc, char * argv[])
     std::vector<std::string> inputs;
     std::vector<std::string> inputFiles;
     std::vector<std::string> exclusionFiles;
+    std::vector<std::string> baselineFiles;
+    std::string newBaselineFile;
+    std::string lexer = "wave";
+    std::string maxMemory = "0";
+    std::string profileReportFile;
+    std::string traceFile;
+    std::string callStatsFile;
+    std::string shard;
+    std::string partialReportFile;
+    std::vector<std::string> partialReports;
     // outputs
     std::vector<std::string> stdreports;
     std::vector<std::string> vcreports;
     std::vector<std::string> xmlreports;
     std::vector<std::string> checkstylereports;
+    std::vector<std::string> sarifreports;
+    std::vector<std::string> jsonlreports;
     /** Define and parse the program options
     */
     namespace po = boost::program_options;
@@ -152,6 +335,17 @@ int boost_main(int argc, char * argv[])
         ("checkstyle-report,c", po::value(&checkstylereports),
             "write the checkstyle report to this file."
             " Not used by default. (note: may be used many times.)")
+        ("sarif-report", po::value(&sarifreports),
+            "write the SARIF 2.1.0 report to this file."
+            " Not used by default. (note: may be used many times.)")
+        ("jsonl-report", po::value(&jsonlreports),
+            "write the report to this file as JSON Lines, with one object per report."
+            " Not used by default. (note: may be used many times.)")
+        ("partial-report", po::value(&partialReportFile), "write the reports and the files"
+            " checked to this file, in a binary form to be merged with --merge-reports")
+        ("merge-reports", po::value(&partialReports)->multitoken(), "write the reports of the"
+            " given partial reports, instead of checking files. The files found in several"
+            " partial reports are only taken from the first one.")
         ("show-rule,s", "include rule name in each report")
         ("no-duplicate,d", "do not duplicate messages if a single rule is violated many times in a"
             " single line of code")
@@ -159,15 +353,42 @@ int boost_main(int argc, char * argv[])
         ("error,e", "reports are marked as error and generated on error output."
             " A non zero exit code is used when one or more reports are generated.")
         ("quiet,q", "don't display the reports")
-        ("summary,S", "display the number of reports and the number of processed files")
+        ("summary,S", "display the number of reports and the number of processed files, with"
+            " the bytes, the lines and the tokens read and lexed, the throughput of the phases,"
+            " the peak memory and the hit rates of the lines and tokens kept in memory")
         ("parameters", po::value(&parameterFiles), "read parameters from file"
             " (note: can be used many times)")
         ("parameter,P", po::value(&parameters), "provide parameters to the scripts as name=value"
             " (note: can be used many times)")
         ("exclusions", po::value(&exclusionFiles), "read exclusions from file"
             " (note: can be used many times)")
+        ("baseline", po::value(&baselineFiles), "don't report the known issues listed in"
+            " this baseline file (note: can be used many times)")
+        ("write-baseline", po::value(&newBaselineFile), "write the baseline of all the reported"
+            " issues to this file")
+        ("lexer", po::value(&lexer), "use the given lexer: wave (the default) or fast - the"
+            " wave lexer only knows the lexical grammar of C++11, and gives up on the invalid"
+            " characters")
+        ("max-memory", po::value(&maxMemory), "keep the lines and the tokens of the files under"
+            " this size, in megabytes or with a K, M or G suffix, by unloading the least recently"
+            " used files and loading them again when needed (0, the default, for no limit)")
+        ("profile-report", po::value(&profileReportFile), "measure the time spent in each"
+            " rule, in each file of the rules and in the load, lex and report phases, and write"
+            " the measures to the standard error and, in JSON, to this file")
+        ("trace-out", po::value(&traceFile), "write the timeline of the run to this file, as"
+            " Chrome trace events (- for the standard output): the loads, the lexing, the rules,"
+            " the calls of the scripts, the reports and the tasks of the threads")
+        ("call-stats", po::value(&callStatsFile), "count the calls of each rule to getTokens,"
+            " with the tokens, the filters and the ranges, to getLine and to report, and write"
+            " them to this file (- for the standard output), with the rules that fetch more"
+            " tokens or lines than the files contain")
         ("inputs,i", po::value(&inputFiles), "the inputs are read from that file (note: one file"
             " per line. can be used many times.)")
+        ("buffers", "read the files and their content from the standard input instead of the"
+            " disk: each file is given by a line with the length of its name and the length of"
+            " its content, in bytes, followed by the name and the content")
+        ("shard", po::value(&shard), "only check the files of the shard i/N, with i from 1"
+            " to N, in a partition of the files by a hash of their name")
         ("root,r", po::value(&veraRoot), "use the given directory as the vera root directory")
         ("help,h", "show this help message and exit")
         ("version", "show vera++'s version and exit");
@@ -205,7 +426,9 @@ int boost_main(int argc, char * argv[])
         // we need the root to be able to find the profiles
         Vera::Plugins::RootDirectory::setRootDirectory(veraRoot);
 
-        if (vm.count("profile") != 0 || (vm.count("rule") == 0 && vm.count("transform") == 0))
+        // the merge of the partial reports doesn't run any rule
+        if (vm.count("merge-reports") == 0 && (vm.count("profile") != 0
+                || (vm.count("rule") == 0 && vm.count("transform") == 0)))
         {
             try
             {
@@ -249,6 +472,14 @@ int boost_main(int argc, char * argv[])
 
     try
     {
+        if (vm.count("merge-reports") && (vm.count("__input__") || vm.count("inputs")
+                || vm.count("buffers") || vm.count("shard")))
+        {
+            std::cerr << "vera++: --merge-reports can't be used with input files or --shard."
+                << std::endl;
+            std::cerr << visibleOptions << std::endl;
+            return EXIT_FAILURE;
+        }
         Vera::Plugins::Reports::setShowRules(vm.count("show-rule"));
         if (vm.count("warning"))
         {
@@ -269,6 +500,17 @@ int boost_main(int argc, char * argv[])
         {
             Vera::Plugins::Exclusions::setExclusions(f);
         }
+        foreach (const std::string & f, baselineFiles)
+        {
+            Vera::Plugins::Baseline::load(f);
+        }
+        Vera::Plugins::Baseline::setRecording(vm.count("write-baseline"));
+        Vera::Structures::Tokens::setLexer(lexer);
+        Vera::Structures::SourceLines::setMaxMemory(parseMemorySize(maxMemory));
+        Vera::Plugins::Profiler::setEnabled(vm.count("profile-report"));
+        Vera::Plugins::Profiler::setPhasesEnabled(vm.count("summary"));
+        Vera::Plugins::Trace::setEnabled(vm.count("trace-out"));
+        Vera::Plugins::CallStats::setEnabled(vm.count("call-stats"));
         foreach (const std::string & f, parameterFiles)
         {
             Vera::Plugins::Parameters::readFromFile(f);
@@ -278,14 +520,32 @@ int boost_main(int argc, char * argv[])
             Vera::Plugins::Parameters::ParamAssoc assoc(p);
             Vera::Plugins::Parameters::set(assoc);
         }
+        if (vm.count("shard"))
+        {
+            setShard(shard);
+        }
         if (vm.count("__input__"))
         {
+            Vera::Structures::SourceTree::DirectoryNameCollection directories;
             foreach (const std::string & i, inputs)
             {
-                Vera::Structures::SourceFiles::addFileName(i);
+                if (Vera::Structures::SourceTree::isDirectory(i))
+                {
+                    directories.push_back(i);
+                }
+                else
+                {
+                    Vera::Structures::SourceFiles::addFileName(i);
+                }
             }
+            Vera::Structures::SourceTree::addDirectories(directories);
         }
-        if (vm.count("__input__") == 0 && vm.count("inputs") == 0)
+        if (vm.count("buffers"))
+        {
+            Vera::Structures::SourceLines::loadBuffers(readBuffers(std::cin));
+        }
+        else if (vm.count("__input__") == 0 && vm.count("inputs") == 0
+            && vm.count("merge-reports") == 0)
         {
             // list of source files is provided on stdin
             inputFiles.push_back("-");
@@ -325,13 +585,18 @@ int boost_main(int argc, char * argv[])
 
         if (vm.count("std-report") == 0 && vm.count("vc-report") == 0
             && vm.count("xml-report") == 0 && vm.count("checkstyle-report") == 0
-            && vm.count("quiet") == 0)
+            && vm.count("sarif-report") == 0 && vm.count("jsonl-report") == 0
+            && vm.count("partial-report") == 0 && vm.count("quiet") == 0)
         {
             // no report set - use std report on std out/err
             stdreports.push_back("-");
         }
 
-        if (rules.empty() == false)
+        if (vm.count("merge-reports"))
+        {
+            Vera::Plugins::Reports::merge(partialReports);
+        }
+        else if (rules.empty() == false)
         {
             if (vm.count("transform"))
             {
@@ -340,25 +605,50 @@ int boost_main(int argc, char * argv[])
                 std::cerr << visibleOptions << std::endl;
                 return EXIT_FAILURE;
             }
-            foreach (const std::string & r, rules)
-            {
-                Vera::Plugins::Rules::executeRule(r);
-            }
+            Vera::Plugins::Rules::executeRules(rules);
         }
         else if (vm.count("transform"))
         {
             Vera::Plugins::Transformations::executeTransformation(transform);
         }
 
-        doReports(stdreports, vm, Vera::Plugins::Reports::writeStd);
-        doReports(vcreports, vm, Vera::Plugins::Reports::writeVc);
-        doReports(xmlreports, vm, Vera::Plugins::Reports::writeXml);
-        doReports(checkstylereports, vm, Vera::Plugins::Reports::writeCheckStyle);
+        if (vm.count("write-baseline"))
+        {
+            Vera::Plugins::Baseline::write(newBaselineFile);
+        }
+
+        {
+            Vera::Plugins::Profiler::Phase phase("report");
+            Vera::Plugins::Trace::Span span("report", "write reports");
+            doReports(vm, stdreports, vcreports, xmlreports, checkstylereports,
+                sarifreports, jsonlreports);
+        }
+
+        if (vm.count("partial-report"))
+        {
+            writeOutput(partialReportFile, Vera::Plugins::Reports::writePartial,
+                std::ios_base::out | std::ios_base::binary);
+        }
+
+        if (vm.count("profile-report"))
+        {
+            writeProfileReport(profileReportFile);
+        }
+        if (vm.count("trace-out"))
+        {
+            writeOutput(traceFile, Vera::Plugins::Trace::write);
+        }
+        if (vm.count("call-stats"))
+        {
+            writeOutput(callStatsFile, Vera::Plugins::CallStats::write);
+        }
 
         if (vm.count("summary"))
         {
             std::cerr << Vera::Plugins::Reports::count() << " reports in "
-                << Vera::Structures::SourceFiles::count() << " files." << std::endl;
+                << Vera::Structures::SourceFiles::count() << " files.\n"
+                << Vera::Plugins::Reports::countFiles() << " files with reports.\n";
+            Vera::Plugins::Profiler::writeSummary(std::cerr);
         }
     }
     catch (const std::exception & e)
@@ -22,34 +22,6 @@
 #include <sys/stat.h>
 #include "get_vera_root_default.h"
 
-namespace // unnamed
-{
-
-// helper function that checks whether the given file name names the C or C++ source file
-bool isSourceFileName(const Vera::Structures::SourceFiles::FileName & name)
-{
-    const std::string suffixes[] =
-        { ".cpp", ".cxx", ".cc", ".c", ".C", ".h", ".hh", ".hpp", ".hxx", ".ipp" };
-
-    const int numOfSuffixes = sizeof(suffixes) / sizeof(std::string);
-    for (int i = 0; i != numOfSuffixes; ++i)
-    {
-        const std::string suf = suffixes[i];
-        const Vera::Structures::SourceFiles::FileName::size_type pos = name.rfind(suf);
-
-        if (pos != Vera::Structures::SourceFiles::FileName::npos &&
-            pos == name.size() - suf.size())
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-} // unnamed namespace
-
-
 int legacy_main(int argc, char * argv[], bool silent = false)
 {
     int exitCodeOnFailure = EXIT_FAILURE;
@@ -273,7 +245,7 @@ int legacy_main(int argc, char * argv[], bool silent = false)
                     return exitCodeOnFailure;
                 }
             }
-            else if (isSourceFileName(arg))
+            else if (Vera::Structures::SourceFiles::isSourceFileName(arg))
             {
                 Vera::Structures::SourceFiles::addFileName(arg);
             }
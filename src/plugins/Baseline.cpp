@@ -0,0 +1,216 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "Baseline.h"
+#include "../structures/SourceLines.h"
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <cstring>
+#include <cerrno>
+#include <boost/unordered_map.hpp>
+
+
+namespace // unnamed
+{
+
+const char * const header = "# vera++ baseline 1";
+
+// fingerprint -> number of reports still matched by it
+typedef boost::unordered_map<Vera::Plugins::Baseline::Fingerprint, unsigned int>
+    FingerprintCounts;
+FingerprintCounts known_;
+bool loaded_;
+
+typedef std::vector<Vera::Plugins::Baseline::Fingerprint> FingerprintCollection;
+FingerprintCollection recorded_;
+bool recording_;
+
+// 64 bits FNV-1a
+const Vera::Plugins::Baseline::Fingerprint fnvOffset = 14695981039346656037ULL;
+const Vera::Plugins::Baseline::Fingerprint fnvPrime = 1099511628211ULL;
+
+void hash(Vera::Plugins::Baseline::Fingerprint & h, unsigned char c)
+{
+    h ^= c;
+    h *= fnvPrime;
+}
+
+void hash(Vera::Plugins::Baseline::Fingerprint & h, const std::string & s)
+{
+    for (std::string::const_iterator it = s.begin(), end = s.end(); it != end; ++it)
+    {
+        hash(h, static_cast<unsigned char>(*it));
+    }
+    hash(h, 0);
+}
+
+// read as the engine, not as a script, so that the call statistics and the
+// trace of the current rule are left alone
+std::string reportedLine(const Vera::Structures::SourceFiles::FileName & name, int lineNumber)
+{
+    // the reports are not always on an existing line (or even file)
+    try
+    {
+        const Vera::Structures::SourceLines::LineCollection & lines =
+            Vera::Structures::SourceLines::peekAllLines(
+                Vera::Structures::SourceFiles::getFileId(name));
+        if (lineNumber >= 1 && lineNumber <= static_cast<int>(lines.size()))
+        {
+            return lines[lineNumber - 1];
+        }
+    }
+    catch (const Vera::Structures::SourceFileError &)
+    {
+    }
+    return std::string();
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Plugins
+{
+
+void Baseline::load(const FileName & name)
+{
+    std::ifstream file(name.c_str());
+    if (file.is_open() == false)
+    {
+        std::ostringstream ss;
+        ss << "Cannot open baseline file " << name << ": " << strerror(errno);
+        throw BaselineError(ss.str());
+    }
+
+    // a file of another tool or of another version of the format
+    std::string line;
+    std::getline(file, line);
+    if (line != header && file.bad() == false)
+    {
+        throw BaselineError("Invalid header in baseline file " + name + ": " + line);
+    }
+
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream ss(line);
+        Fingerprint fp;
+        ss >> std::hex >> fp;
+        if (ss.fail())
+        {
+            throw BaselineError("Invalid fingerprint in baseline file " + name + ": " + line);
+        }
+        ++known_[fp];
+    }
+    if (file.bad())
+    {
+        throw BaselineError("Cannot read from baseline file " + name + ": " + strerror(errno));
+    }
+    loaded_ = true;
+}
+
+void Baseline::setRecording(bool recording)
+{
+    recording_ = recording;
+}
+
+void Baseline::write(const FileName & name)
+{
+    std::sort(recorded_.begin(), recorded_.end());
+
+    std::ofstream file(name.c_str());
+    if (file.is_open() == false)
+    {
+        std::ostringstream ss;
+        ss << "Cannot open baseline file " << name << ": " << strerror(errno);
+        throw BaselineError(ss.str());
+    }
+    file << header << '\n' << std::hex << std::setfill('0');
+    for (FingerprintCollection::const_iterator it = recorded_.begin(), end = recorded_.end();
+         it != end; ++it)
+    {
+        file << std::setw(16) << *it << '\n';
+    }
+    file.close();
+    if (file.fail())
+    {
+        throw BaselineError("Cannot write to baseline file " + name + ": " + strerror(errno));
+    }
+}
+
+bool Baseline::isKnown(const Structures::SourceFiles::FileName & name, int lineNumber,
+    const Rules::RuleName & rule)
+{
+    if (loaded_ == false && recording_ == false)
+    {
+        return false;
+    }
+
+    const Fingerprint fp = fingerprint(name, rule, reportedLine(name, lineNumber));
+    if (recording_)
+    {
+        recorded_.push_back(fp);
+    }
+
+    const FingerprintCounts::iterator it = known_.find(fp);
+    if (it != known_.end() && it->second != 0)
+    {
+        --it->second;
+        return true;
+    }
+    return false;
+}
+
+Baseline::Fingerprint Baseline::fingerprint(const Structures::SourceFiles::FileName & name,
+    const Rules::RuleName & rule, const std::string & line)
+{
+    Fingerprint h = fnvOffset;
+    hash(h, rule);
+    hash(h, name);
+    for (std::string::const_iterator it = line.begin(), end = line.end(); it != end; ++it)
+    {
+        const unsigned char c = static_cast<unsigned char>(*it);
+        if (std::isspace(c) == 0)
+        {
+            hash(h, c);
+        }
+    }
+    return h;
+}
+
+struct Baseline::State
+{
+    State() : loaded_(false), recording_(false) {}
+
+    FingerprintCounts known_;
+    bool loaded_;
+    FingerprintCollection recorded_;
+    bool recording_;
+};
+
+boost::shared_ptr<Baseline::State> Baseline::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void Baseline::swapState(State & state)
+{
+    known_.swap(state.known_);
+    std::swap(loaded_, state.loaded_);
+    recorded_.swap(state.recorded_);
+    std::swap(recording_, state.recording_);
+}
+
+}
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BASELINE_H_INCLUDED
+#define BASELINE_H_INCLUDED
+
+#include <string>
+#include <stdexcept>
+#include <boost/cstdint.hpp>
+#include "../structures/SourceFiles.h"
+#include "Rules.h"
+#include <boost/shared_ptr.hpp>
+
+
+namespace Vera
+{
+namespace Plugins
+{
+
+class BaselineError : public std::runtime_error
+{
+public:
+    BaselineError(const std::string & msg) : std::runtime_error(msg) {}
+};
+
+// The baseline is the set of the known reports. A report is identified by a
+// fingerprint computed from the rule, the file name and the content of the
+// reported line (without its white spaces), so it survives the line moves.
+class Baseline
+{
+public:
+    typedef std::string FileName;
+    typedef boost::uint64_t Fingerprint;
+
+    static void load(const FileName & name);
+    static void setRecording(bool recording);
+    static void write(const FileName & name);
+
+    // true if the report is in the baseline - each fingerprint of the
+    // baseline matches as many reports as it was found when it was recorded
+    static bool isKnown(const Structures::SourceFiles::FileName & name, int lineNumber,
+        const Rules::RuleName & rule);
+
+    static Fingerprint fingerprint(const Structures::SourceFiles::FileName & name,
+        const Rules::RuleName & rule, const std::string & line);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
+};
+
+} // namespace Plugins
+
+} // namespace Vera
+
+#endif // BASELINE_H_INCLUDED
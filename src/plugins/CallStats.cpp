@@ -0,0 +1,307 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "CallStats.h"
+#include "Rules.h"
+#include "../structures/SourceLines.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <vector>
+
+
+namespace // unnamed
+{
+
+struct FileCalls
+{
+    FileCalls() : getTokens_(0), tokens_(0), getLine_(0), fileTokens_(0), fileLines_(0) {}
+
+    std::size_t getTokens_;
+    std::size_t tokens_;
+    std::size_t getLine_;
+
+    // the size of the file when it is used
+    std::size_t fileTokens_;
+    std::size_t fileLines_;
+};
+
+// by file name, as the ids are only valid in the session that gave them
+typedef std::map<Vera::Structures::SourceFiles::FileName, FileCalls> FileCallsMap;
+typedef std::map<std::string, std::size_t> CountMap;
+
+struct RuleCalls
+{
+    RuleCalls()
+        : getTokens_(0), tokens_(0), getLine_(0), getAllLines_(0), getLineCount_(0),
+        report_(0) {}
+
+    std::size_t getTokens_;
+    std::size_t tokens_;
+    std::size_t getLine_;
+    std::size_t getAllLines_;
+    std::size_t getLineCount_;
+    std::size_t report_;
+
+    // the calls of getTokens by filter and by number of lines in the range
+    CountMap filters_;
+    CountMap ranges_;
+
+    FileCallsMap files_;
+};
+
+typedef std::map<Vera::Plugins::Rules::RuleName, RuleCalls> RuleCallsMap;
+
+bool enabled = false;
+RuleCallsMap rules;
+
+RuleCalls & currentRule()
+{
+    return rules[Vera::Plugins::Rules::getCurrentRule()];
+}
+
+std::string filterName(const Vera::Structures::Tokens::FilterSequence & filter)
+{
+    if (filter.empty())
+    {
+        return "(all)";
+    }
+    std::string res;
+    for (Vera::Structures::Tokens::FilterSequence::const_iterator it = filter.begin();
+         it != filter.end(); ++it)
+    {
+        res += it == filter.begin() ? "" : " ";
+        res += *it;
+    }
+    return res;
+}
+
+std::string rangeName(int fromLine, int toLine, std::size_t fileLines)
+{
+    if (fromLine <= 1 && toLine <= 0)
+    {
+        return "file";
+    }
+    const std::size_t lines = toLine <= 0
+        ? (fileLines >= static_cast<std::size_t>(fromLine) ? fileLines - fromLine + 1 : 0)
+        : static_cast<std::size_t>(toLine - fromLine + 1);
+    if (lines <= 1)
+    {
+        return "1 line";
+    }
+    if (lines <= 10)
+    {
+        return "2-10 lines";
+    }
+    if (lines <= 100)
+    {
+        return "11-100 lines";
+    }
+    return ">100 lines";
+}
+
+void writeCounts(std::ostream & os, const char * title, const CountMap & counts)
+{
+    os << "  " << std::left << std::setw(10) << title << std::right;
+    for (CountMap::const_iterator it = counts.begin(); it != counts.end(); ++it)
+    {
+        os << (it == counts.begin() ? "" : ", ") << it->first << ": " << it->second;
+    }
+    os << '\n';
+}
+
+// a file where a rule fetched more than the file contains
+struct Excess
+{
+    Vera::Structures::SourceFiles::FileName file_;
+    std::size_t used_;
+    std::size_t size_;
+};
+
+typedef std::vector<Excess> ExcessCollection;
+
+void addExcess(ExcessCollection & excesses, const Vera::Structures::SourceFiles::FileName & file,
+    std::size_t used, std::size_t size)
+{
+    // an empty file is still used once
+    if (used > std::max<std::size_t>(size, 1))
+    {
+        Excess excess;
+        excess.file_ = file;
+        excess.used_ = used;
+        excess.size_ = size;
+        excesses.push_back(excess);
+    }
+}
+
+// the worst file, with the number of the other ones
+void writeExcess(std::ostream & os, const std::string & rule, const ExcessCollection & excesses,
+    const char * verb, const char * usedUnit, const char * sizeUnit)
+{
+    if (excesses.empty())
+    {
+        return;
+    }
+    ExcessCollection::const_iterator worst = excesses.begin();
+    for (ExcessCollection::const_iterator it = excesses.begin(); it != excesses.end(); ++it)
+    {
+        // used / size > worst used / worst size, without the division by 0
+        if (it->used_ * std::max<std::size_t>(worst->size_, 1)
+            > worst->used_ * std::max<std::size_t>(it->size_, 1))
+        {
+            worst = it;
+        }
+    }
+    os << rule << ": " << verb << ' ' << worst->used_ << ' ' << usedUnit << ' '
+        << worst->file_
+        << ", which has " << worst->size_ << ' ' << sizeUnit;
+    if (excesses.size() > 1)
+    {
+        os << " (and " << excesses.size() - 1 << " other files)";
+    }
+    os << '\n';
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Plugins
+{
+
+void CallStats::setEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+bool CallStats::isEnabled()
+{
+    return enabled;
+}
+
+void CallStats::countGetTokens(Structures::SourceFiles::FileId id, int fromLine, int toLine,
+    const Structures::Tokens::FilterSequence & filter, std::size_t tokens)
+{
+    if (enabled)
+    {
+        RuleCalls & rule = currentRule();
+        FileCalls & file = rule.files_[Structures::SourceFiles::getFileName(id)];
+        file.fileTokens_ = Structures::Tokens::getTokenCount(id);
+        file.fileLines_ = Structures::SourceLines::peekAllLines(id).size();
+        ++file.getTokens_;
+        file.tokens_ += tokens;
+
+        ++rule.getTokens_;
+        rule.tokens_ += tokens;
+        ++rule.filters_[filterName(filter)];
+        ++rule.ranges_[rangeName(fromLine, toLine, file.fileLines_)];
+    }
+}
+
+void CallStats::countGetLine(Structures::SourceFiles::FileId id)
+{
+    if (enabled)
+    {
+        RuleCalls & rule = currentRule();
+        FileCalls & file = rule.files_[Structures::SourceFiles::getFileName(id)];
+        file.fileLines_ = Structures::SourceLines::peekAllLines(id).size();
+        ++file.getLine_;
+        ++rule.getLine_;
+    }
+}
+
+void CallStats::countGetAllLines()
+{
+    if (enabled)
+    {
+        ++currentRule().getAllLines_;
+    }
+}
+
+void CallStats::countGetLineCount()
+{
+    if (enabled)
+    {
+        ++currentRule().getLineCount_;
+    }
+}
+
+void CallStats::countReport()
+{
+    if (enabled)
+    {
+        ++currentRule().report_;
+    }
+}
+
+void CallStats::write(std::ostream & os)
+{
+    os << std::left << std::setw(20) << "rule" << std::right << std::setw(12) << "getTokens"
+        << std::setw(12) << "tokens" << std::setw(12) << "getLine" << std::setw(14)
+        << "getAllLines" << std::setw(14) << "getLineCount" << std::setw(10) << "report" << '\n';
+    for (RuleCallsMap::const_iterator it = rules.begin(); it != rules.end(); ++it)
+    {
+        const RuleCalls & rule = it->second;
+        os << std::left << std::setw(20) << it->first << std::right
+            << std::setw(12) << rule.getTokens_
+            << std::setw(12) << rule.tokens_
+            << std::setw(12) << rule.getLine_
+            << std::setw(14) << rule.getAllLines_
+            << std::setw(14) << rule.getLineCount_
+            << std::setw(10) << rule.report_ << '\n';
+        if (rule.getTokens_ != 0)
+        {
+            writeCounts(os, "filters", rule.filters_);
+            writeCounts(os, "ranges", rule.ranges_);
+        }
+    }
+
+    std::ostringstream warnings;
+    for (RuleCallsMap::const_iterator it = rules.begin(); it != rules.end(); ++it)
+    {
+        ExcessCollection tokens;
+        ExcessCollection getTokens;
+        ExcessCollection getLine;
+        const FileCallsMap & files = it->second.files_;
+        for (FileCallsMap::const_iterator fit = files.begin(); fit != files.end(); ++fit)
+        {
+            addExcess(tokens, fit->first, fit->second.tokens_, fit->second.fileTokens_);
+            addExcess(getTokens, fit->first, fit->second.getTokens_, fit->second.fileLines_);
+            addExcess(getLine, fit->first, fit->second.getLine_, fit->second.fileLines_);
+        }
+        writeExcess(warnings, it->first, tokens, "fetched", "tokens from", "tokens");
+        writeExcess(warnings, it->first, getTokens, "called getTokens", "times on", "lines");
+        writeExcess(warnings, it->first, getLine, "called getLine", "times on", "lines");
+    }
+    if (warnings.str().empty() == false)
+    {
+        os << "\nthe rules that fetch more than the files contain:\n" << warnings.str();
+    }
+}
+
+struct CallStats::State
+{
+    State() : enabled_(false) {}
+
+    bool enabled_;
+    RuleCallsMap rules_;
+};
+
+boost::shared_ptr<CallStats::State> CallStats::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void CallStats::swapState(State & state)
+{
+    std::swap(enabled, state.enabled_);
+    rules.swap(state.rules_);
+}
+
+}
+}
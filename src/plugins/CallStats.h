@@ -0,0 +1,52 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef CALLSTATS_H_INCLUDED
+#define CALLSTATS_H_INCLUDED
+
+#include "../structures/SourceFiles.h"
+#include "../structures/Tokens.h"
+#include <boost/shared_ptr.hpp>
+#include <ostream>
+
+
+namespace Vera
+{
+namespace Plugins
+{
+
+// Counts the calls of the scripts to the bindings, for each rule, to find the
+// scripts that fetch the same lines and tokens again and again. Nothing is
+// counted until it is enabled.
+class CallStats
+{
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // with the number of tokens returned
+    static void countGetTokens(Structures::SourceFiles::FileId id, int fromLine, int toLine,
+        const Structures::Tokens::FilterSequence & filter, std::size_t tokens);
+    static void countGetLine(Structures::SourceFiles::FileId id);
+    static void countGetAllLines();
+    static void countGetLineCount();
+    static void countReport();
+
+    // the calls of each rule, then the rules that fetch more than the files contain
+    static void write(std::ostream & os);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
+};
+
+} // namespace Plugins
+
+} // namespace Vera
+
+#endif // CALLSTATS_H_INCLUDED
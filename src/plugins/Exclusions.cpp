@@ -13,8 +13,10 @@
 #include <sstream>
 #include <cstring>
 #include <cerrno>
+#include <vector>
+#include <map>
+#include <algorithm>
 #include <boost/regex.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/foreach.hpp>
 
 #define foreach BOOST_FOREACH
@@ -27,8 +29,233 @@ typedef std::set<Vera::Structures::SourceFiles::FileName> FileNameSet;
 typedef std::map<Vera::Plugins::Rules::RuleName, FileNameSet> ExclusionMap;
 ExclusionMap exclusions;
 
+// the source files, in the order of the file set, with their ids
+Vera::Plugins::Exclusions::FileNameCollection allFiles;
+Vera::Structures::SourceFiles::FileIdCollection allFileIds;
+
+// the files excluded for a rule, indexed by file id, and the files kept
+struct RuleFiles
+{
+    std::vector<bool> excluded_;
+    Vera::Plugins::Exclusions::FileNameCollection names_;
+};
+
+typedef std::map<Vera::Plugins::Rules::RuleName, RuleFiles> RuleFilesMap;
+RuleFilesMap ruleFiles;
+
+// the files of the current batch, indexed by file id, and the files of the
+// batch kept for the last rule
+std::vector<bool> inBatch;
+bool batchSet = false;
+Vera::Plugins::Exclusions::FileNameCollection batchFiles;
+
+std::string baseName(const Vera::Structures::SourceFiles::FileName & name)
+{
+    return name.substr(name.find_last_of("\\/") + 1);
+}
+
+void updateAllFiles()
+{
+    const Vera::Structures::SourceFiles::FileNameSet & files =
+        Vera::Structures::SourceFiles::getAllFileNames();
+    if (files.size() == allFiles.size())
+    {
+        // the files are only added to the set
+        return;
+    }
+
+    allFiles.assign(files.begin(), files.end());
+    allFileIds.clear();
+    allFileIds.reserve(allFiles.size());
+    foreach(const Vera::Structures::SourceFiles::FileName & name, allFiles)
+    {
+        allFileIds.push_back(Vera::Structures::SourceFiles::getFileId(name));
+    }
+    ruleFiles.clear();
+}
+
 typedef std::vector<boost::regex> RegexList;
-RegexList exclusionRegexs;
+
+// The exclusion regexs are matched against "file:line: rule: msg". A regex
+// that contains the literal ": rule: " can only match the reports of that rule,
+// so the regexs are partitioned by rule, and the regexs of a partition are
+// combined in a single alternation matched in a single search.
+struct ExclusionRegex
+{
+    std::string source_;
+    // empty if the regex may match the reports of any rule
+    Vera::Plugins::Rules::RuleName rule_;
+};
+
+typedef std::vector<ExclusionRegex> ExclusionRegexCollection;
+ExclusionRegexCollection exclusionRegexs;
+
+typedef std::map<Vera::Plugins::Rules::RuleName, RegexList> CompiledRegexMap;
+CompiledRegexMap compiledRegexs;
+RegexList allRegexs;
+
+// reused to format the reports
+std::string formattedReport;
+
+bool isIdentifierChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// returns the rule name of a mandatory ": rule: " literal in the regex, if any
+Vera::Plugins::Rules::RuleName ruleOf(const std::string & re)
+{
+    Vera::Plugins::Rules::RuleName rule;
+    int depth = 0;
+    for (std::string::size_type i = 0; i < re.size(); ++i)
+    {
+        const char c = re[i];
+        if (c == '\\')
+        {
+            ++i;
+        }
+        else if (c == '(' && re.compare(i, 2, "(?") == 0
+            && re.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ-", i + 2)
+                == re.find(')', i + 2))
+        {
+            // the flags, such as (?i), change how the literal matches the rest
+            return Vera::Plugins::Rules::RuleName();
+        }
+        else if (c == '(' || c == '[')
+        {
+            // anything in a group or a set is not a literal, or may be optional
+            ++depth;
+        }
+        else if ((c == ')' || c == ']') && depth > 0)
+        {
+            --depth;
+        }
+        else if (depth == 0 && c == '|')
+        {
+            // an alternative may match without the literal
+            return Vera::Plugins::Rules::RuleName();
+        }
+        else if (depth == 0 && rule.empty() && c == ':' && i + 2 < re.size()
+            && re[i + 1] == ' ' && isIdentifierChar(re[i + 2]))
+        {
+            std::string::size_type end = i + 2;
+            while (end < re.size() && isIdentifierChar(re[end]))
+            {
+                ++end;
+            }
+            if (end < re.size() && re[end] == ':'
+                && (end + 1 == re.size() || (re[end + 1] != '?' && re[end + 1] != '*'
+                    && re[end + 1] != '{')))
+            {
+                rule = re.substr(i + 2, end - i - 2);
+            }
+        }
+    }
+    return rule;
+}
+
+// the regexs can't be put in an alternation when they use back references
+// or constructs that extend to the end of the expression
+bool isCombinable(const std::string & re)
+{
+    for (std::string::size_type i = 0; i + 1 < re.size(); ++i)
+    {
+        if (re[i] == '\\')
+        {
+            const char next = re[i + 1];
+            if ((next >= '1' && next <= '9') || next == 'g' || next == 'k' || next == 'Q')
+            {
+                return false;
+            }
+            ++i;
+        }
+        else if (re[i] == '(' && re[i + 1] == '?')
+        {
+            const std::string::size_type end = re.find_first_of(":)", i + 2);
+            if (re.substr(i + 2, end - i - 2).find('x') != std::string::npos)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+RegexList compile(const std::vector<std::string> & sources)
+{
+    RegexList res;
+    std::string combined;
+    BOOST_FOREACH(const std::string & re, sources)
+    {
+        if (isCombinable(re))
+        {
+            if (combined.empty() == false)
+            {
+                combined += '|';
+            }
+            combined += "(?:" + re + ")";
+        }
+        else
+        {
+            res.push_back(boost::regex(re));
+        }
+    }
+    if (combined.empty() == false)
+    {
+        res.push_back(boost::regex(combined));
+    }
+    return res;
+}
+
+const RegexList & regexsForRule(const Vera::Plugins::Rules::RuleName & rule)
+{
+    const CompiledRegexMap::const_iterator it = compiledRegexs.find(rule);
+    if (it != compiledRegexs.end())
+    {
+        return it->second;
+    }
+    std::vector<std::string> sources;
+    BOOST_FOREACH(const ExclusionRegex & re, exclusionRegexs)
+    {
+        if (re.rule_.empty() || re.rule_ == rule)
+        {
+            sources.push_back(re.source_);
+        }
+    }
+    return compiledRegexs[rule] = compile(sources);
+}
+
+const RegexList & regexsForAllRules()
+{
+    if (allRegexs.empty())
+    {
+        std::vector<std::string> sources;
+        BOOST_FOREACH(const ExclusionRegex & re, exclusionRegexs)
+        {
+            sources.push_back(re.source_);
+        }
+        allRegexs = compile(sources);
+    }
+    return allRegexs;
+}
+
+void appendNumber(std::string & s, int n)
+{
+    char digits[16];
+    char * p = digits + sizeof(digits);
+    unsigned int u = n < 0 ? 0u - static_cast<unsigned int>(n) : static_cast<unsigned int>(n);
+    do
+    {
+        *--p = static_cast<char>('0' + u % 10);
+        u /= 10;
+    }
+    while (u != 0);
+    if (n < 0)
+    {
+        *--p = '-';
+    }
+    s.append(p, digits + sizeof(digits));
+}
 
 } // unnamed namespace
 
@@ -65,7 +292,12 @@ void Exclusions::setExclusionsRegex(const ExclusionFileName & fileName)
         // don't process empty lines and lines begining with a #
         if (re.empty() == false && re.substr(0, 1) != "#")
         {
-          exclusionRegexs.push_back(boost::regex(re));
+            // make sure the regex is valid now, it is compiled later
+            boost::regex check(re);
+            ExclusionRegex exclusion;
+            exclusion.source_ = re;
+            exclusion.rule_ = ruleOf(re);
+            exclusionRegexs.push_back(exclusion);
         }
     }
     if (exclusionsFile.bad())
@@ -73,6 +305,8 @@ void Exclusions::setExclusionsRegex(const ExclusionFileName & fileName)
         throw std::runtime_error(
             "Cannot read from " + fileName + ": " + strerror(errno));
     }
+    compiledRegexs.clear();
+    allRegexs.clear();
 }
 
 void Exclusions::setExclusionsTcl(const ExclusionFileName & fileName)
@@ -112,16 +346,34 @@ void Exclusions::setExclusionsTcl(const ExclusionFileName & fileName)
 
         exclusions[ruleName] = files;
     }
+    ruleFiles.clear();
 }
 
 bool Exclusions::isExcluded(const Structures::SourceFiles::FileName & name,
   int lineNumber, const Rules::RuleName & currentRule, const std::string & msg)
 {
-    std::string fmsg = name + ":" + boost::lexical_cast<std::string>(lineNumber)
-        + ": " + currentRule + ": " + msg;
-    foreach(boost::regex const& re, exclusionRegexs)
+    if (exclusionRegexs.empty())
     {
-        if (boost::regex_search(fmsg, re))
+        return false;
+    }
+
+    formattedReport.assign(name);
+    formattedReport += ':';
+    appendNumber(formattedReport, lineNumber);
+    formattedReport += ": ";
+    formattedReport += currentRule;
+    formattedReport += ": ";
+    formattedReport += msg;
+
+    // the partition of the rule can only be used when the file name and the
+    // message can't be confused with the rule part of the report
+    const bool ambiguous = name.find(": ") != std::string::npos
+        || msg.find(": ") != std::string::npos;
+    const RegexList & regexs = ambiguous ? regexsForAllRules() : regexsForRule(currentRule);
+
+    foreach(boost::regex const& re, regexs)
+    {
+        if (boost::regex_search(formattedReport, re))
         {
             return true;
         }
@@ -134,18 +386,123 @@ bool Exclusions::isExcluded(const Structures::SourceFiles::FileName & name)
     const Rules::RuleName currentRule = Rules::getCurrentRule();
 
     const ExclusionMap::const_iterator eit = exclusions.find(currentRule);
-    if (eit != exclusions.end())
+    if (eit == exclusions.end())
     {
-        const FileNameSet & files = eit->second;
+        return false;
+    }
 
-        const FileNameSet::const_iterator fit =
-            files.find(name.substr(name.find_last_of("\\/") + 1));
-        return fit != files.end();
+    getRuleSourceFileNames(currentRule);
+    const RuleFilesMap::const_iterator rit = ruleFiles.find(currentRule);
+    const Structures::SourceFiles::FileId id = Structures::SourceFiles::getFileId(name);
+    if (rit != ruleFiles.end() && static_cast<std::size_t>(id) < rit->second.excluded_.size())
+    {
+        return rit->second.excluded_[id];
     }
-    else
+
+    const FileNameSet & files = eit->second;
+    return files.find(baseName(name)) != files.end();
+}
+
+void Exclusions::setBatch(const FileNameCollection & batch)
+{
+    batchSet = batch.empty() == false;
+    inBatch.assign(Structures::SourceFiles::getFileIdCount(), false);
+    foreach(const Structures::SourceFiles::FileName & name, batch)
     {
-        return false;
+        inBatch[Structures::SourceFiles::getFileId(name)] = true;
+    }
+}
+
+const Exclusions::FileNameCollection & Exclusions::getSourceFileNames(
+    const Rules::RuleName & rule)
+{
+    const FileNameCollection & files = getRuleSourceFileNames(rule);
+    if (batchSet == false)
+    {
+        return files;
+    }
+
+    batchFiles.clear();
+    foreach(const Structures::SourceFiles::FileName & name, files)
+    {
+        const Structures::SourceFiles::FileId id = Structures::SourceFiles::getFileId(name);
+        if (static_cast<std::size_t>(id) < inBatch.size() && inBatch[id])
+        {
+            batchFiles.push_back(name);
+        }
+    }
+    return batchFiles;
+}
+
+const Exclusions::FileNameCollection & Exclusions::getRuleSourceFileNames(
+    const Rules::RuleName & rule)
+{
+    updateAllFiles();
+
+    const ExclusionMap::const_iterator eit = exclusions.find(rule);
+    if (eit == exclusions.end() || eit->second.empty())
+    {
+        return allFiles;
+    }
+
+    const RuleFilesMap::const_iterator rit = ruleFiles.find(rule);
+    if (rit != ruleFiles.end())
+    {
+        return rit->second.names_;
     }
+
+    const FileNameSet & excludedFiles = eit->second;
+    RuleFiles & res = ruleFiles[rule];
+    const Structures::SourceFiles::FileId count = Structures::SourceFiles::getFileIdCount();
+    res.excluded_.resize(count);
+    for (Structures::SourceFiles::FileId id = 0; id != count; ++id)
+    {
+        res.excluded_[id] = excludedFiles.find(
+            baseName(Structures::SourceFiles::getFileName(id))) != excludedFiles.end();
+    }
+    for (std::vector<std::string>::size_type i = 0; i != allFiles.size(); ++i)
+    {
+        if (res.excluded_[allFileIds[i]] == false)
+        {
+            res.names_.push_back(allFiles[i]);
+        }
+    }
+    return res.names_;
+}
+
+struct Exclusions::State
+{
+    State() : batchSet_(false) {}
+
+    ExclusionMap exclusions_;
+    FileNameCollection allFiles_;
+    Structures::SourceFiles::FileIdCollection allFileIds_;
+    RuleFilesMap ruleFiles_;
+    std::vector<bool> inBatch_;
+    bool batchSet_;
+    FileNameCollection batchFiles_;
+    ExclusionRegexCollection exclusionRegexs_;
+    CompiledRegexMap compiledRegexs_;
+    RegexList allRegexs_;
+};
+
+boost::shared_ptr<Exclusions::State> Exclusions::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void Exclusions::swapState(State & state)
+{
+    exclusions.swap(state.exclusions_);
+    allFiles.swap(state.allFiles_);
+    allFileIds.swap(state.allFileIds_);
+    ruleFiles.swap(state.ruleFiles_);
+    inBatch.swap(state.inBatch_);
+    std::swap(batchSet, state.batchSet_);
+    batchFiles.swap(state.batchFiles_);
+    exclusionRegexs.swap(state.exclusionRegexs_);
+    compiledRegexs.swap(state.compiledRegexs_);
+    allRegexs.swap(state.allRegexs_);
 }
 
 }
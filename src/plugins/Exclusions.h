@@ -9,9 +9,11 @@
 #define EXCLUSIONS_H_INCLUDED
 
 #include <string>
+#include <vector>
 #include "../structures/SourceFiles.h"
 #include "Rules.h"
 #include <stdexcept>
+#include <boost/shared_ptr.hpp>
 
 
 namespace Vera
@@ -29,6 +31,7 @@ class Exclusions
 {
 public:
     typedef std::string ExclusionFileName;
+    typedef std::vector<Structures::SourceFiles::FileName> FileNameCollection;
 
     static void setExclusions(const ExclusionFileName & name);
     static void setExclusionsTcl(const ExclusionFileName & name);
@@ -37,6 +40,21 @@ public:
     static bool isExcluded(const Structures::SourceFiles::FileName & name);
     static bool isExcluded(const Structures::SourceFiles::FileName & name,
         int lineNumber, const Rules::RuleName & currentRule, const std::string & msg);
+
+    // the source files that are not excluded for the rule - the list is
+    // computed once per rule and per set of source files
+    static const FileNameCollection & getSourceFileNames(const Rules::RuleName & rule);
+
+    // when the batch is not empty, the rules only see its files
+    static void setBatch(const FileNameCollection & batch);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
+
+private:
+    static const FileNameCollection & getRuleSourceFileNames(const Rules::RuleName & rule);
 };
 
 } // namespace Plugins
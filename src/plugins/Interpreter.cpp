@@ -6,17 +6,14 @@
 //
 
 #include "Interpreter.h"
+#include "ScriptCatalog.h"
 #include "Exclusions.h"
 #include "Reports.h"
 #include "Parameters.h"
 #include "../structures/SourceFiles.h"
 #include "../structures/SourceLines.h"
 #include "../structures/Tokens.h"
-#include <fstream>
-#include <iterator>
 #include <boost/lexical_cast.hpp>
-#include <boost/filesystem.hpp>
-#include <boost/algorithm/string/predicate.hpp>
 
 #include "tcl/TclInterpreter.h"
 #ifdef VERA_PYTHON
@@ -31,78 +28,31 @@ namespace Vera
 namespace Plugins
 {
 
-void Interpreter::execute(const DirectoryName & root,
+Interpreter::ScriptName Interpreter::findScript(const DirectoryName & root,
     ScriptType type, const ScriptName & name)
 {
-    std::string scriptDir = root + "/scripts/";
-    std::string scriptDir2 = root + "/";
-    switch (type)
-    {
-    case rule:
-        scriptDir += "rules/";
-        scriptDir2 += "rules/";
-        break;
-    case transformation:
-        scriptDir += "transformations/";
-        scriptDir2 += "transformations/";
-        break;
-    }
+    return ScriptCatalog::find(root, type, name).fileName_;
+}
 
-    // first look at tcl rules
-    std::string tclName = name;
-    if (boost::algorithm::ends_with(tclName, ".tcl") == false)
-    {
-      tclName += ".tcl";
-    }
-    if (boost::filesystem::exists(scriptDir + tclName))
-    {
-        TclInterpreter::execute(scriptDir + tclName);
-        return;
-    }
-    else if (boost::filesystem::exists(scriptDir2 + tclName))
-    {
-        TclInterpreter::execute(scriptDir2 + tclName);
-        return;
-    }
+void Interpreter::execute(const DirectoryName & root,
+    ScriptType type, const ScriptName & name)
+{
+    const ScriptCatalog::Script & script = ScriptCatalog::find(root, type, name);
 #ifdef VERA_PYTHON
-    // then python
-    std::string pyName = name;
-    if (boost::algorithm::ends_with(pyName, ".py") == false)
-    {
-      pyName += ".py";
-    }
-    if (boost::filesystem::exists(scriptDir + pyName))
-    {
-        PythonInterpreter::execute(scriptDir + pyName);
-        return;
-    }
-    else if (boost::filesystem::exists(scriptDir2 + pyName))
+    if (script.language_ == ScriptCatalog::python)
     {
-        PythonInterpreter::execute(scriptDir2 + pyName);
+        PythonInterpreter::execute(script.fileName_);
         return;
     }
 #endif
 #ifdef VERA_LUA
-    // then lua
-    std::string luaName = name;
-    if (boost::algorithm::ends_with(luaName, ".lua") == false)
-    {
-      luaName += ".lua";
-    }
-    if (boost::filesystem::exists(scriptDir + luaName))
-    {
-        LuaInterpreter::execute(scriptDir + luaName);
-        return;
-    }
-    else if (boost::filesystem::exists(scriptDir2 + luaName))
+    if (script.language_ == ScriptCatalog::lua)
     {
-        LuaInterpreter::execute(scriptDir2 + luaName);
+        LuaInterpreter::execute(script.fileName_);
         return;
     }
 #endif
-    std::ostringstream ss;
-    ss << "cannot open script " << name;
-    throw ScriptError(ss.str());
+    TclInterpreter::execute(script.fileName_, script.body_);
 }
 
 }
@@ -9,6 +9,7 @@
 #define INTERPRETER_H_INCLUDED
 
 #include <stdexcept>
+#include <string>
 
 
 namespace Vera
@@ -32,6 +33,11 @@ public:
     typedef std::string DirectoryName;
     typedef std::string ScriptName;
 
+    // the file of the script, looked for in the scripts and the root
+    // directories, in Tcl, then in Python and in Lua
+    static ScriptName findScript(const DirectoryName & root,
+        ScriptType type, const ScriptName & name);
+
     static void execute(const DirectoryName & root,
         ScriptType type, const ScriptName & name);
 };
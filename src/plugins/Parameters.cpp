@@ -96,5 +96,20 @@ void Parameters::readFromFile(const FileName & name)
     file.close();
 }
 
+struct Parameters::State
+{
+    ParametersCollection parameters_;
+};
+
+boost::shared_ptr<Parameters::State> Parameters::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void Parameters::swapState(State & state)
+{
+    parameters_.swap(state.parameters_);
+}
+
 }
 }
@@ -10,6 +10,7 @@
 
 #include <string>
 #include <stdexcept>
+#include <boost/shared_ptr.hpp>
 
 
 namespace Vera
@@ -37,6 +38,11 @@ public:
     static void readFromFile(const FileName & name);
 
     static ParamValue get(const ParamName & name, const ParamValue & defaultValue);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
 };
 
 } // namespace Plugins
@@ -0,0 +1,485 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "Profiler.h"
+#include "ReportWriters.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+
+namespace // unnamed
+{
+
+typedef Vera::Structures::SourceFiles::FileId FileId;
+
+struct Times
+{
+    Times() : wall_(0), cpu_(0), count_(0), bytes_(0) {}
+
+    // in seconds
+    double wall_;
+    double cpu_;
+    std::size_t count_;
+    std::size_t bytes_;
+};
+
+struct Clock
+{
+    boost::posix_time::ptime wall_;
+    std::clock_t cpu_;
+};
+
+Clock now()
+{
+    Clock clock;
+    clock.wall_ = boost::posix_time::microsec_clock::universal_time();
+    clock.cpu_ = std::clock();
+    return clock;
+}
+
+void addTimes(Times & times, const boost::posix_time::ptime & wall, std::clock_t cpu,
+    const Clock & to)
+{
+    times.wall_ += (to.wall_ - wall).total_microseconds() / 1e6;
+    times.cpu_ += static_cast<double>(to.cpu_ - cpu) / CLOCKS_PER_SEC;
+    ++times.count_;
+}
+
+// by file name, as the ids are only valid in the session that gave them
+typedef std::map<Vera::Structures::SourceFiles::FileName, Times> FileTimesMap;
+
+struct RuleTimes
+{
+    Times times_;
+    FileTimesMap files_;
+};
+
+typedef std::map<Vera::Plugins::Rules::RuleName, RuleTimes> RuleTimesMap;
+typedef std::map<Vera::Plugins::Profiler::PhaseName, Times> PhaseTimesMap;
+
+bool enabled = false;
+bool phasesEnabled = false;
+RuleTimesMap rules;
+PhaseTimesMap phases;
+
+boost::posix_time::ptime runStart;
+std::size_t counters[Vera::Plugins::Profiler::counterCount];
+std::size_t cacheHits[Vera::Plugins::Profiler::cacheCount];
+std::size_t cacheMisses[Vera::Plugins::Profiler::cacheCount];
+
+// the rule being run, and the file its script uses, if any
+RuleTimes * currentRule = 0;
+Clock ruleStart;
+bool inFile = false;
+FileId currentFile = 0;
+Clock fileStart;
+
+void stopFile(const Clock & clock)
+{
+    if (inFile)
+    {
+        addTimes(currentRule->files_[Vera::Structures::SourceFiles::getFileName(currentFile)],
+            fileStart.wall_, fileStart.cpu_, clock);
+        inFile = false;
+    }
+}
+
+// the names and the times, to be sorted with the slowest first
+struct NamedTimes
+{
+    NamedTimes(const std::string & name, const std::string & rule, const Times & times)
+        : name_(name), rule_(rule), times_(times) {}
+
+    std::string name_;
+    std::string rule_;
+    Times times_;
+};
+
+typedef std::vector<NamedTimes> NamedTimesCollection;
+
+bool slowerThan(const NamedTimes & left, const NamedTimes & right)
+{
+    if (left.times_.wall_ != right.times_.wall_)
+    {
+        return left.times_.wall_ > right.times_.wall_;
+    }
+    return left.name_ < right.name_;
+}
+
+NamedTimesCollection getRules()
+{
+    NamedTimesCollection res;
+    for (RuleTimesMap::const_iterator it = rules.begin(); it != rules.end(); ++it)
+    {
+        res.push_back(NamedTimes(it->first, it->first, it->second.times_));
+    }
+    std::sort(res.begin(), res.end(), slowerThan);
+    return res;
+}
+
+NamedTimesCollection getFiles(const RuleTimes & rule, const std::string & ruleName)
+{
+    NamedTimesCollection res;
+    for (FileTimesMap::const_iterator it = rule.files_.begin(); it != rule.files_.end(); ++it)
+    {
+        res.push_back(NamedTimes(it->first, ruleName, it->second));
+    }
+    std::sort(res.begin(), res.end(), slowerThan);
+    return res;
+}
+
+NamedTimesCollection getPhases()
+{
+    NamedTimesCollection res;
+    for (PhaseTimesMap::const_iterator it = phases.begin(); it != phases.end(); ++it)
+    {
+        res.push_back(NamedTimes(it->first, std::string(), it->second));
+    }
+    std::sort(res.begin(), res.end(), slowerThan);
+    return res;
+}
+
+void writeRow(std::ostream & os, const std::string & name, const Times & times)
+{
+    os << std::left << std::setw(40) << name << std::right
+        << std::setw(12) << times.wall_
+        << std::setw(12) << times.cpu_
+        << std::setw(10) << times.count_;
+}
+
+void appendTimes(std::string & buffer, const Times & times)
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(6)
+        << "\"wall\": " << times.wall_ << ", \"cpu\": " << times.cpu_
+        << ", \"count\": " << times.count_;
+    buffer += ss.str();
+}
+
+// at most this number of files in the table
+const std::size_t slowestFiles = 20;
+
+// in bytes, 0 if unknown
+std::size_t getPeakMemory()
+{
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double perSecond(double count, double seconds)
+{
+    return seconds > 0 ? count / seconds : 0;
+}
+
+void writeThroughput(std::ostream & os, const char * what, const Times & times,
+    std::size_t bytes, std::size_t items, const char * itemName)
+{
+    os << what << ' ' << times.count_ << " files: " << bytes << " bytes, " << items << ' '
+        << itemName << " in " << std::setprecision(3) << times.wall_ << " s ("
+        << std::setprecision(2) << perSecond(bytes / (1024.0 * 1024.0), times.wall_)
+        << " MB/s, " << std::setprecision(0)
+        << perSecond(static_cast<double>(times.count_), times.wall_) << " files/s, "
+        << perSecond(static_cast<double>(items), times.wall_) << ' ' << itemName << "/s)\n";
+}
+
+void writeCache(std::ostream & os, const char * name, std::size_t hits, std::size_t misses)
+{
+    os << name << " cache: " << hits << " hits, " << misses << " misses";
+    if (hits + misses != 0)
+    {
+        os << " (" << std::setprecision(1) << 100.0 * hits / (hits + misses) << "%)";
+    }
+    os << '\n';
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Plugins
+{
+
+void Profiler::setEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+bool Profiler::isEnabled()
+{
+    return enabled;
+}
+
+void Profiler::setPhasesEnabled(bool enable)
+{
+    phasesEnabled = enable;
+    runStart = boost::posix_time::microsec_clock::universal_time();
+}
+
+void Profiler::addCount(Counter counter, std::size_t count)
+{
+    counters[counter] += count;
+}
+
+void Profiler::countCacheUse(Cache cache, bool hit)
+{
+    ++(hit ? cacheHits : cacheMisses)[cache];
+}
+
+void Profiler::startRule(const Rules::RuleName & name)
+{
+    if (enabled)
+    {
+        currentRule = &rules[name];
+        inFile = false;
+        ruleStart = now();
+    }
+}
+
+void Profiler::stopRule()
+{
+    if (enabled && currentRule != 0)
+    {
+        const Clock clock = now();
+        stopFile(clock);
+        addTimes(currentRule->times_, ruleStart.wall_, ruleStart.cpu_, clock);
+        currentRule = 0;
+    }
+}
+
+void Profiler::useFile(Structures::SourceFiles::FileId id)
+{
+    if (enabled && currentRule != 0 && (inFile == false || currentFile != id))
+    {
+        const Clock clock = now();
+        stopFile(clock);
+        inFile = true;
+        currentFile = id;
+        fileStart = clock;
+    }
+}
+
+Profiler::Phase::Phase(const PhaseName & name)
+    : name_(name), enabled_(enabled || phasesEnabled), cpu_(0), bytes_(0)
+{
+    if (enabled_)
+    {
+        const Clock clock = now();
+        wall_ = clock.wall_;
+        cpu_ = clock.cpu_;
+    }
+}
+
+Profiler::Phase::~Phase()
+{
+    if (enabled_)
+    {
+        Times & times = phases[name_];
+        addTimes(times, wall_, cpu_, now());
+        times.bytes_ += bytes_;
+    }
+}
+
+void Profiler::Phase::addBytes(std::size_t bytes)
+{
+    bytes_ += bytes;
+}
+
+void Profiler::writeTable(std::ostream & os)
+{
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+
+    os << std::left << std::setw(40) << "rule" << std::right << std::setw(12) << "wall (s)"
+        << std::setw(12) << "cpu (s)" << std::setw(10) << "runs" << '\n';
+    NamedTimesCollection files;
+    const NamedTimesCollection ruleTimes = getRules();
+    for (NamedTimesCollection::const_iterator it = ruleTimes.begin();
+         it != ruleTimes.end(); ++it)
+    {
+        writeRow(os, it->name_, it->times_);
+        os << '\n';
+
+        const NamedTimesCollection ruleFiles = getFiles(rules[it->name_], it->name_);
+        files.insert(files.end(), ruleFiles.begin(), ruleFiles.end());
+    }
+
+    os << '\n' << std::left << std::setw(40) << "file" << std::right << std::setw(12)
+        << "wall (s)" << std::setw(12) << "cpu (s)" << std::setw(10) << "uses" << "  rule\n";
+    std::sort(files.begin(), files.end(), slowerThan);
+    for (std::size_t i = 0; i != files.size() && i != slowestFiles; ++i)
+    {
+        writeRow(os, files[i].name_, files[i].times_);
+        os << "  " << files[i].rule_ << '\n';
+    }
+
+    os << '\n' << std::left << std::setw(40) << "phase" << std::right << std::setw(12)
+        << "wall (s)" << std::setw(12) << "cpu (s)" << std::setw(10) << "runs"
+        << std::setw(14) << "bytes" << '\n';
+    const NamedTimesCollection phaseTimes = getPhases();
+    for (NamedTimesCollection::const_iterator it = phaseTimes.begin();
+         it != phaseTimes.end(); ++it)
+    {
+        writeRow(os, it->name_, it->times_);
+        os << std::setw(14) << it->times_.bytes_ << '\n';
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void Profiler::writeJson(std::ostream & os)
+{
+    std::string buffer = "{\n  \"rules\": [";
+    const NamedTimesCollection ruleTimes = getRules();
+    for (NamedTimesCollection::const_iterator it = ruleTimes.begin();
+         it != ruleTimes.end(); ++it)
+    {
+        buffer += it == ruleTimes.begin() ? "\n" : ",\n";
+        buffer += "    { \"name\": ";
+        ReportWriter::appendJsonString(buffer, it->name_);
+        buffer += ", ";
+        appendTimes(buffer, it->times_);
+        buffer += ",\n      \"files\": [";
+
+        const NamedTimesCollection ruleFiles = getFiles(rules[it->name_], it->name_);
+        for (NamedTimesCollection::const_iterator fit = ruleFiles.begin();
+             fit != ruleFiles.end(); ++fit)
+        {
+            buffer += fit == ruleFiles.begin() ? "\n" : ",\n";
+            buffer += "        { \"name\": ";
+            ReportWriter::appendJsonString(buffer, fit->name_);
+            buffer += ", ";
+            appendTimes(buffer, fit->times_);
+            buffer += " }";
+        }
+        buffer += ruleFiles.empty() ? "] }" : "\n      ] }";
+    }
+    buffer += ruleTimes.empty() ? "],\n" : "\n  ],\n";
+
+    buffer += "  \"phases\": [";
+    const NamedTimesCollection phaseTimes = getPhases();
+    for (NamedTimesCollection::const_iterator it = phaseTimes.begin();
+         it != phaseTimes.end(); ++it)
+    {
+        buffer += it == phaseTimes.begin() ? "\n" : ",\n";
+        buffer += "    { \"name\": ";
+        ReportWriter::appendJsonString(buffer, it->name_);
+        buffer += ", ";
+        appendTimes(buffer, it->times_);
+        std::ostringstream ss;
+        ss << ", \"bytes\": " << it->times_.bytes_ << " }";
+        buffer += ss.str();
+    }
+    buffer += phaseTimes.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+    os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+void Profiler::writeSummary(std::ostream & os)
+{
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed;
+
+    writeThroughput(os, "read", phases["load"], counters[bytesRead], counters[linesRead],
+        "lines");
+    writeThroughput(os, "lexed", phases["lex"], counters[bytesLexed], counters[tokensLexed],
+        "tokens");
+
+    const double wall = (boost::posix_time::microsec_clock::universal_time() - runStart)
+        .total_microseconds() / 1e6;
+    const std::size_t files = static_cast<std::size_t>(Structures::SourceFiles::count());
+    os << "checked " << files << " files in " << std::setprecision(3) << wall << " s ("
+        << std::setprecision(0) << perSecond(static_cast<double>(files), wall) << " files/s, "
+        << std::setprecision(2) << perSecond(counters[bytesRead] / (1024.0 * 1024.0), wall)
+        << " MB/s, " << std::setprecision(0)
+        << perSecond(static_cast<double>(counters[tokensLexed]), wall) << " tokens/s)\n";
+
+    const std::size_t peak = getPeakMemory();
+    if (peak != 0)
+    {
+        os << "peak memory: " << std::setprecision(1) << peak / (1024.0 * 1024.0) << " MB\n";
+    }
+    writeCache(os, "lines", cacheHits[linesCache], cacheMisses[linesCache]);
+    writeCache(os, "tokens", cacheHits[tokensCache], cacheMisses[tokensCache]);
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+struct Profiler::State
+{
+    State()
+        : enabled_(false), phasesEnabled_(false), currentRule_(0), inFile_(false),
+        currentFile_(0)
+    {
+        std::fill(counters_, counters_ + counterCount, 0);
+        std::fill(cacheHits_, cacheHits_ + cacheCount, 0);
+        std::fill(cacheMisses_, cacheMisses_ + cacheCount, 0);
+    }
+
+    bool enabled_;
+    bool phasesEnabled_;
+    RuleTimesMap rules_;
+    PhaseTimesMap phases_;
+
+    boost::posix_time::ptime runStart_;
+    std::size_t counters_[counterCount];
+    std::size_t cacheHits_[cacheCount];
+    std::size_t cacheMisses_[cacheCount];
+
+    RuleTimes * currentRule_;
+    Clock ruleStart_;
+    bool inFile_;
+    FileId currentFile_;
+    Clock fileStart_;
+};
+
+boost::shared_ptr<Profiler::State> Profiler::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void Profiler::swapState(State & state)
+{
+    std::swap(enabled, state.enabled_);
+    std::swap(phasesEnabled, state.phasesEnabled_);
+    rules.swap(state.rules_);
+    phases.swap(state.phases_);
+    std::swap(runStart, state.runStart_);
+    std::swap_ranges(counters, counters + counterCount, state.counters_);
+    std::swap_ranges(cacheHits, cacheHits + cacheCount, state.cacheHits_);
+    std::swap_ranges(cacheMisses, cacheMisses + cacheCount, state.cacheMisses_);
+    std::swap(currentRule, state.currentRule_);
+    std::swap(ruleStart, state.ruleStart_);
+    std::swap(inFile, state.inFile_);
+    std::swap(currentFile, state.currentFile_);
+    std::swap(fileStart, state.fileStart_);
+}
+
+}
+}
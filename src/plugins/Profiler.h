@@ -0,0 +1,90 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef PROFILER_H_INCLUDED
+#define PROFILER_H_INCLUDED
+
+#include "Rules.h"
+#include "../structures/SourceFiles.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/shared_ptr.hpp>
+#include <ctime>
+#include <ostream>
+#include <string>
+
+
+namespace Vera
+{
+namespace Plugins
+{
+
+// Measures the wall and CPU times of the rules, of the files in each rule,
+// and of the load, lex and report phases. Nothing is measured until it is
+// enabled.
+class Profiler
+{
+public:
+    typedef std::string PhaseName;
+
+    enum Counter { bytesRead, linesRead, bytesLexed, tokensLexed, counterCount };
+
+    // the lines and the tokens kept in memory for the files
+    enum Cache { linesCache, tokensCache, cacheCount };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // only the phases, the counters and the caches, for the summary of the run
+    static void setPhasesEnabled(bool enabled);
+
+    static void addCount(Counter counter, std::size_t count);
+    static void countCacheUse(Cache cache, bool hit);
+
+    static void startRule(const Rules::RuleName & name);
+    static void stopRule();
+
+    // The time of the current rule is counted for the file its script uses,
+    // until it uses another one.
+    static void useFile(Structures::SourceFiles::FileId id);
+
+    // measures a phase, with the bytes it allocates, while it exists
+    class Phase
+    {
+    public:
+        explicit Phase(const PhaseName & name);
+        ~Phase();
+
+        void addBytes(std::size_t bytes);
+
+    private:
+        const PhaseName name_;
+        const bool enabled_;
+        boost::posix_time::ptime wall_;
+        std::clock_t cpu_;
+        std::size_t bytes_;
+    };
+
+    // the rules, then the slowest files of the rules, and the phases,
+    // the slowest first
+    static void writeTable(std::ostream & os);
+    static void writeJson(std::ostream & os);
+
+    // the totals, the throughput of the phases, the peak memory and the cache
+    // hit rates
+    static void writeSummary(std::ostream & os);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
+};
+
+} // namespace Plugins
+
+} // namespace Vera
+
+#endif // PROFILER_H_INCLUDED
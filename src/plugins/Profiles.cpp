@@ -131,14 +131,7 @@ Profiles::RuleNameCollection Profiles::getListOfScriptNames(
 
 void Profiles::executeProfile(const ProfileName & profile)
 {
-    const RuleNameCollection scripts = getListOfScriptNames(profile);
-
-    typedef RuleNameCollection::const_iterator iterator;
-    const iterator end = scripts.end();
-    for (iterator it = scripts.begin(); it != end; ++it)
-    {
-        Rules::executeRule(*it);
-    }
+    Rules::executeRules(getListOfScriptNames(profile));
 }
 
 }
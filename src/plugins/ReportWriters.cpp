@@ -0,0 +1,594 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "ReportWriters.h"
+#include "config.h"
+#include <algorithm>
+#include <cctype>
+
+
+namespace // unnamed
+{
+
+// the buffer is written to the stream when it grows over this size
+const std::string::size_type blockSize = 64 * 1024;
+
+// The escaping is driven by tables indexed by the byte value: a null entry
+// means that the byte is copied as is, otherwise the entry is its replacement.
+class EscapeTable
+{
+public:
+    const char * operator[](char c) const
+    {
+        return entries_[static_cast<unsigned char>(c)];
+    }
+
+protected:
+    EscapeTable()
+    {
+        for (int i = 0; i != 256; ++i)
+        {
+            entries_[i] = 0;
+        }
+    }
+
+    void set(unsigned char c, const char * replacement)
+    {
+        entries_[c] = replacement;
+    }
+
+private:
+    const char * entries_[256];
+};
+
+class XmlEscapeTable : public EscapeTable
+{
+public:
+    XmlEscapeTable()
+    {
+        set('&', "&amp;");
+        set('"', "&quot;");
+        set('\'', "&apos;");
+        set('<', "&lt;");
+        set('>', "&gt;");
+    }
+};
+
+class JsonEscapeTable : public EscapeTable
+{
+public:
+    JsonEscapeTable()
+    {
+        static const char hex[] = "0123456789abcdef";
+        for (int c = 0; c != 0x20; ++c)
+        {
+            char * e = controls_[c];
+            std::copy(&"\\u00"[0], &"\\u00"[4], e);
+            e[4] = hex[c >> 4];
+            e[5] = hex[c & 0xf];
+            e[6] = '\0';
+            set(static_cast<unsigned char>(c), e);
+        }
+        set('"', "\\\"");
+        set('\\', "\\\\");
+        set('\b', "\\b");
+        set('\f', "\\f");
+        set('\n', "\\n");
+        set('\r', "\\r");
+        set('\t', "\\t");
+        set(0x7f, "\\u007f");
+    }
+
+private:
+    char controls_[0x20][7];
+};
+
+// everything but the unreserved characters and the path separators
+// is percent-encoded in the file URIs
+class UriEscapeTable : public EscapeTable
+{
+public:
+    UriEscapeTable()
+    {
+        static const char hex[] = "0123456789ABCDEF";
+        for (int c = 0; c != 256; ++c)
+        {
+            char * e = encoded_[c];
+            e[0] = '%';
+            e[1] = hex[c >> 4];
+            e[2] = hex[c & 0xf];
+            e[3] = '\0';
+            if (std::isalnum(c) == 0 || c > 0x7f)
+            {
+                set(static_cast<unsigned char>(c), e);
+            }
+        }
+        set('-', 0);
+        set('.', 0);
+        set('_', 0);
+        set('~', 0);
+        set('/', 0);
+        set('\\', "/");
+    }
+
+private:
+    char encoded_[256][4];
+};
+
+const XmlEscapeTable xmlEscapes;
+const JsonEscapeTable jsonEscapes;
+const UriEscapeTable uriEscapes;
+
+// the byte at the position exists and is in the range
+bool isContinuation(const std::string & s, std::string::size_type pos,
+    unsigned char low, unsigned char high)
+{
+    if (pos >= s.size())
+    {
+        return false;
+    }
+    const unsigned char c = static_cast<unsigned char>(s[pos]);
+    return c >= low && c <= high;
+}
+
+// the length of the UTF-8 sequence at the position, or 0 if it is not valid:
+// the overlong forms, the surrogates and the code points over U+10FFFF are not
+std::string::size_type utf8Length(const std::string & s, std::string::size_type pos)
+{
+    const unsigned char c = static_cast<unsigned char>(s[pos]);
+    if (c < 0x80)
+    {
+        return 1;
+    }
+    if (c >= 0xc2 && c <= 0xdf)
+    {
+        return isContinuation(s, pos + 1, 0x80, 0xbf) ? 2 : 0;
+    }
+    if (c >= 0xe0 && c <= 0xef)
+    {
+        const unsigned char low = c == 0xe0 ? 0xa0 : 0x80;
+        const unsigned char high = c == 0xed ? 0x9f : 0xbf;
+        return isContinuation(s, pos + 1, low, high)
+            && isContinuation(s, pos + 2, 0x80, 0xbf) ? 3 : 0;
+    }
+    if (c >= 0xf0 && c <= 0xf4)
+    {
+        const unsigned char low = c == 0xf0 ? 0x90 : 0x80;
+        const unsigned char high = c == 0xf4 ? 0x8f : 0xbf;
+        return isContinuation(s, pos + 1, low, high)
+            && isContinuation(s, pos + 2, 0x80, 0xbf)
+            && isContinuation(s, pos + 3, 0x80, 0xbf) ? 4 : 0;
+    }
+    return 0;
+}
+
+void appendEscaped(std::string & buffer, const std::string & s, const EscapeTable & table)
+{
+    std::string::const_iterator chunk = s.begin();
+    for (std::string::const_iterator it = s.begin(), end = s.end(); it != end; ++it)
+    {
+        const char * replacement = table[*it];
+        if (replacement != 0)
+        {
+            buffer.append(chunk, it);
+            buffer += replacement;
+            chunk = it + 1;
+        }
+    }
+    buffer.append(chunk, s.end());
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Plugins
+{
+
+ReportWriter::ReportWriter(std::ostream & os, const std::string & prefix, bool showRules)
+    : prefix_(prefix), showRules_(showRules), os_(os)
+{
+    buffer_.reserve(blockSize + 1024);
+}
+
+ReportWriter::~ReportWriter()
+{
+}
+
+void ReportWriter::begin(const RuleNameCollection &)
+{
+}
+
+void ReportWriter::beginFile(const std::string &)
+{
+}
+
+void ReportWriter::endFile()
+{
+}
+
+void ReportWriter::end()
+{
+}
+
+void ReportWriter::finish()
+{
+    os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    os_.flush();
+    buffer_.clear();
+}
+
+void ReportWriter::put(const std::string & s)
+{
+    buffer_ += s;
+    flushIfFull();
+}
+
+void ReportWriter::put(const char * s)
+{
+    buffer_ += s;
+    flushIfFull();
+}
+
+void ReportWriter::put(char c)
+{
+    buffer_ += c;
+    flushIfFull();
+}
+
+void ReportWriter::put(int n)
+{
+    char digits[16];
+    char * p = digits + sizeof(digits);
+    const bool negative = n < 0;
+    unsigned int u = negative ? 0u - static_cast<unsigned int>(n) : static_cast<unsigned int>(n);
+    do
+    {
+        *--p = static_cast<char>('0' + u % 10);
+        u /= 10;
+    }
+    while (u != 0);
+    if (negative)
+    {
+        *--p = '-';
+    }
+    buffer_.append(p, digits + sizeof(digits));
+    flushIfFull();
+}
+
+void ReportWriter::putXmlEscaped(const std::string & s)
+{
+    appendEscaped(buffer_, s, xmlEscapes);
+    flushIfFull();
+}
+
+void ReportWriter::putXmlCData(const std::string & s)
+{
+    // "]]>" can't appear in a CDATA section, so the section is split there
+    buffer_ += "<![CDATA[";
+    std::string::size_type start = 0;
+    std::string::size_type pos;
+    while ((pos = s.find("]]>", start)) != std::string::npos)
+    {
+        buffer_.append(s, start, pos + 2 - start);
+        buffer_ += "]]><![CDATA[";
+        start = pos + 2;
+    }
+    buffer_.append(s, start, std::string::npos);
+    buffer_ += "]]>";
+    flushIfFull();
+}
+
+void ReportWriter::appendJsonString(std::string & buffer, const std::string & s)
+{
+    // JSON is UTF-8: the bytes of the file names and of the messages that are
+    // not valid UTF-8 are replaced with U+FFFD, one by one
+    buffer += '"';
+    std::string::size_type chunk = 0;
+    std::string::size_type pos = 0;
+    while (pos != s.size())
+    {
+        const std::string::size_type length = utf8Length(s, pos);
+        const char * replacement = length == 0 ? "\\ufffd" : jsonEscapes[s[pos]];
+        if (replacement != 0)
+        {
+            buffer.append(s, chunk, pos - chunk);
+            buffer += replacement;
+            chunk = pos + 1;
+        }
+        pos += length == 0 ? 1 : length;
+    }
+    buffer.append(s, chunk, std::string::npos);
+    buffer += '"';
+}
+
+void ReportWriter::putJsonString(const std::string & s)
+{
+    appendJsonString(buffer_, s);
+    flushIfFull();
+}
+
+void ReportWriter::putUri(const std::string & fileName)
+{
+    if (fileName.empty() == false && (fileName[0] == '/' || fileName[0] == '\\'))
+    {
+        buffer_ += "file://";
+    }
+    else if (fileName.size() > 1 && fileName[1] == ':'
+        && std::isalpha(static_cast<unsigned char>(fileName[0])))
+    {
+        // windows absolute path
+        buffer_ += "file:///";
+        buffer_ += fileName[0];
+        buffer_ += ':';
+        appendEscaped(buffer_, fileName.substr(2), uriEscapes);
+        flushIfFull();
+        return;
+    }
+    appendEscaped(buffer_, fileName, uriEscapes);
+    flushIfFull();
+}
+
+void ReportWriter::flushIfFull()
+{
+    if (buffer_.size() >= blockSize)
+    {
+        os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+}
+
+StdReportWriter::StdReportWriter(std::ostream & os, const std::string & prefix, bool showRules)
+    : ReportWriter(os, prefix, showRules)
+{
+}
+
+void StdReportWriter::report(const std::string & name, int lineNumber,
+    const std::string & rule, const std::string & msg)
+{
+    put(name);
+    put(':');
+    put(lineNumber);
+    put(':');
+    if (prefix_ != "")
+    {
+        put(' ');
+        put(prefix_);
+    }
+    if (showRules_)
+    {
+        put(' ');
+        put(rule);
+    }
+    if (showRules_ || prefix_ != "")
+    {
+        put(':');
+    }
+    put(' ');
+    put(msg);
+    put('\n');
+}
+
+VcReportWriter::VcReportWriter(std::ostream & os, const std::string & prefix, bool showRules)
+    : ReportWriter(os, prefix, showRules)
+{
+}
+
+void VcReportWriter::report(const std::string & name, int lineNumber,
+    const std::string & rule, const std::string & msg)
+{
+    put(name);
+    put('(');
+    put(lineNumber);
+    put("):");
+    if (prefix_ != "")
+    {
+        put(' ');
+        put(prefix_);
+    }
+    if (showRules_)
+    {
+        put(' ');
+        put(rule);
+    }
+    if (showRules_ || prefix_ != "")
+    {
+        put(':');
+    }
+    put(' ');
+    put(msg);
+    put('\n');
+}
+
+XmlReportWriter::XmlReportWriter(std::ostream & os, const std::string & prefix, bool showRules)
+    : ReportWriter(os, prefix, showRules)
+{
+}
+
+void XmlReportWriter::begin(const RuleNameCollection &)
+{
+    put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    put("<vera>\n");
+}
+
+void XmlReportWriter::beginFile(const std::string & name)
+{
+    put("    <file name=\"");
+    putXmlEscaped(name);
+    put("\">\n");
+}
+
+void XmlReportWriter::report(const std::string &, int lineNumber,
+    const std::string & rule, const std::string & msg)
+{
+    if (showRules_)
+    {
+        put("        <report rule=\"");
+        putXmlEscaped(rule);
+        put("\" line=\"");
+    }
+    else
+    {
+        put("        <report line=\"");
+    }
+    put(lineNumber);
+    put("\">");
+    putXmlCData(msg);
+    put("</report>\n");
+}
+
+void XmlReportWriter::endFile()
+{
+    put("    </file>\n");
+}
+
+void XmlReportWriter::end()
+{
+    put("</vera>\n");
+}
+
+CheckStyleReportWriter::CheckStyleReportWriter(std::ostream & os, const std::string & prefix,
+    bool showRules)
+    : ReportWriter(os, prefix, showRules), severity_(prefix)
+{
+    if (severity_ == "")
+    {
+        severity_ = "info";
+    }
+}
+
+void CheckStyleReportWriter::begin(const RuleNameCollection &)
+{
+    put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    put("<checkstyle version=\"5.0\">\n");
+}
+
+void CheckStyleReportWriter::beginFile(const std::string & name)
+{
+    put("    <file name=\"");
+    putXmlEscaped(name);
+    put("\">\n");
+}
+
+void CheckStyleReportWriter::report(const std::string &, int lineNumber,
+    const std::string & rule, const std::string & msg)
+{
+    put("        <error source=\"");
+    putXmlEscaped(rule);
+    put("\" severity=\"");
+    putXmlEscaped(severity_);
+    put("\" line=\"");
+    put(lineNumber);
+    put("\" message=\"");
+    putXmlEscaped(msg);
+    put("\" />\n");
+}
+
+void CheckStyleReportWriter::endFile()
+{
+    put("    </file>\n");
+}
+
+void CheckStyleReportWriter::end()
+{
+    put("</checkstyle>\n");
+}
+
+SarifReportWriter::SarifReportWriter(std::ostream & os, const std::string & prefix,
+    bool showRules)
+    : ReportWriter(os, prefix, showRules), level_(prefix), firstResult_(true)
+{
+    if (level_ != "error" && level_ != "warning")
+    {
+        level_ = "note";
+    }
+}
+
+void SarifReportWriter::begin(const RuleNameCollection & rules)
+{
+    put("{\n");
+    put("  \"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\",\n");
+    put("  \"version\": \"2.1.0\",\n");
+    put("  \"runs\": [\n");
+    put("    {\n");
+    put("      \"tool\": {\n");
+    put("        \"driver\": {\n");
+    put("          \"name\": \"vera++\",\n");
+    put("          \"version\": \"" VERA_VERSION "\",\n");
+    put("          \"rules\": [");
+    int index = 0;
+    for (RuleNameCollection::const_iterator it = rules.begin(), end = rules.end();
+         it != end; ++it, ++index)
+    {
+        put(index == 0 ? "\n" : ",\n");
+        put("            { \"id\": ");
+        putJsonString(*it);
+        put(" }");
+        ruleIndexes_[*it] = index;
+    }
+    put(index == 0 ? "]\n" : "\n          ]\n");
+    put("        }\n");
+    put("      },\n");
+    put("      \"results\": [");
+}
+
+void SarifReportWriter::report(const std::string & name, int lineNumber,
+    const std::string & rule, const std::string & msg)
+{
+    put(firstResult_ ? "\n" : ",\n");
+    firstResult_ = false;
+    put("        { \"ruleId\": ");
+    putJsonString(rule);
+    put(", \"ruleIndex\": ");
+    put(ruleIndexes_[rule]);
+    put(", \"level\": \"");
+    put(level_);
+    put("\", \"message\": { \"text\": ");
+    putJsonString(msg);
+    put(" }, \"locations\": [ { \"physicalLocation\": { \"artifactLocation\": { \"uri\": \"");
+    putUri(name);
+    put("\" }, \"region\": { \"startLine\": ");
+    put(lineNumber);
+    put(" } } } ] }");
+}
+
+void SarifReportWriter::end()
+{
+    put(firstResult_ ? "]\n" : "\n      ]\n");
+    put("    }\n");
+    put("  ]\n");
+    put("}\n");
+}
+
+JsonLinesReportWriter::JsonLinesReportWriter(std::ostream & os, const std::string & prefix,
+    bool showRules)
+    : ReportWriter(os, prefix, showRules), severity_(prefix)
+{
+    if (severity_ == "")
+    {
+        severity_ = "info";
+    }
+}
+
+void JsonLinesReportWriter::report(const std::string & name, int lineNumber,
+    const std::string & rule, const std::string & msg)
+{
+    put("{\"file\":");
+    putJsonString(name);
+    put(",\"line\":");
+    put(lineNumber);
+    put(",\"rule\":");
+    putJsonString(rule);
+    put(",\"severity\":\"");
+    put(severity_);
+    put("\",\"message\":");
+    putJsonString(msg);
+    put("}\n");
+}
+
+}
+}
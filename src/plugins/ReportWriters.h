@@ -0,0 +1,149 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef REPORTWRITERS_H_INCLUDED
+#define REPORTWRITERS_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <boost/unordered_map.hpp>
+
+
+namespace Vera
+{
+namespace Plugins
+{
+
+// Formats the reports in a private buffer that is written to the stream with
+// large block writes. The writers that share a stream must not run at the same
+// time: Reports::write runs them one after the other.
+class ReportWriter
+{
+public:
+    typedef std::vector<std::string> RuleNameCollection;
+
+    ReportWriter(std::ostream & os, const std::string & prefix, bool showRules);
+    virtual ~ReportWriter();
+
+
+    virtual void begin(const RuleNameCollection & rules);
+    virtual void beginFile(const std::string & name);
+    virtual void report(const std::string & name, int lineNumber,
+        const std::string & rule, const std::string & msg) = 0;
+    virtual void endFile();
+    virtual void end();
+
+    void finish();
+
+    // the string quoted and escaped for JSON, as used by the other JSON outputs
+    static void appendJsonString(std::string & buffer, const std::string & s);
+
+protected:
+    void put(const std::string & s);
+    void put(const char * s);
+    void put(char c);
+    void put(int n);
+    void putXmlEscaped(const std::string & s);
+    void putXmlCData(const std::string & s);
+    void putJsonString(const std::string & s);
+    void putUri(const std::string & fileName);
+
+    const std::string prefix_;
+    const bool showRules_;
+
+private:
+    void flushIfFull();
+
+    std::ostream & os_;
+    std::string buffer_;
+};
+
+class StdReportWriter : public ReportWriter
+{
+public:
+    StdReportWriter(std::ostream & os, const std::string & prefix, bool showRules);
+
+    virtual void report(const std::string & name, int lineNumber,
+        const std::string & rule, const std::string & msg);
+};
+
+class VcReportWriter : public ReportWriter
+{
+public:
+    VcReportWriter(std::ostream & os, const std::string & prefix, bool showRules);
+
+    virtual void report(const std::string & name, int lineNumber,
+        const std::string & rule, const std::string & msg);
+};
+
+class XmlReportWriter : public ReportWriter
+{
+public:
+    XmlReportWriter(std::ostream & os, const std::string & prefix, bool showRules);
+
+    virtual void begin(const RuleNameCollection & rules);
+    virtual void beginFile(const std::string & name);
+    virtual void report(const std::string & name, int lineNumber,
+        const std::string & rule, const std::string & msg);
+    virtual void endFile();
+    virtual void end();
+};
+
+class CheckStyleReportWriter : public ReportWriter
+{
+public:
+    CheckStyleReportWriter(std::ostream & os, const std::string & prefix, bool showRules);
+
+    virtual void begin(const RuleNameCollection & rules);
+    virtual void beginFile(const std::string & name);
+    virtual void report(const std::string & name, int lineNumber,
+        const std::string & rule, const std::string & msg);
+    virtual void endFile();
+    virtual void end();
+
+private:
+    std::string severity_;
+};
+
+// SARIF 2.1.0, as expected by the code scanning tools
+class SarifReportWriter : public ReportWriter
+{
+public:
+    SarifReportWriter(std::ostream & os, const std::string & prefix, bool showRules);
+
+    virtual void begin(const RuleNameCollection & rules);
+    virtual void report(const std::string & name, int lineNumber,
+        const std::string & rule, const std::string & msg);
+    virtual void end();
+
+private:
+    typedef boost::unordered_map<std::string, int> RuleIndexMap;
+
+    std::string level_;
+    RuleIndexMap ruleIndexes_;
+    bool firstResult_;
+};
+
+// one JSON object per report and per line
+class JsonLinesReportWriter : public ReportWriter
+{
+public:
+    JsonLinesReportWriter(std::ostream & os, const std::string & prefix, bool showRules);
+
+    virtual void report(const std::string & name, int lineNumber,
+        const std::string & rule, const std::string & msg);
+
+private:
+    std::string severity_;
+};
+
+} // namespace Plugins
+
+} // namespace Vera
+
+#endif // REPORTWRITERS_H_INCLUDED
@@ -8,32 +8,430 @@
 #include "Reports.h"
 #include "Rules.h"
 #include "Exclusions.h"
+#include "Baseline.h"
+#include "CallStats.h"
+#include "ReportWriters.h"
+#include "../structures/SourceFiles.h"
+#include <fstream>
 #include <sstream>
+#include <vector>
+#include <set>
 #include <map>
+#include <algorithm>
 #include <utility>
 #include <stdexcept>
-#include <boost/algorithm/string/replace.hpp>
+#include <cstring>
+#include <cerrno>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/shared_ptr.hpp>
 
 
 namespace // unnamed
 {
 
-// for a single report
-typedef std::pair<Vera::Plugins::Rules::RuleName, Vera::Plugins::Reports::Message> SingleReport;
+// strings stored once and referenced by their index
+// (the elements of an unordered_map are not moved by a rehash, so the
+// keys can be referenced directly)
+class StringTable
+{
+public:
+    typedef boost::uint32_t Id;
+
+    Id intern(const std::string & s)
+    {
+        const IndexMap::const_iterator it = index_.find(s);
+        if (it != index_.end())
+        {
+            return it->second;
+        }
+        const Id id = static_cast<Id>(strings_.size());
+        const IndexMap::const_iterator inserted = index_.insert(std::make_pair(s, id)).first;
+        strings_.push_back(&inserted->first);
+        return id;
+    }
+
+    const std::string & get(Id id) const
+    {
+        return *strings_[id];
+    }
+
+    Id size() const
+    {
+        return static_cast<Id>(strings_.size());
+    }
+
+    // the nodes of the map are exchanged, so the pointers to its keys stay valid
+    void swap(StringTable & other)
+    {
+        index_.swap(other.index_);
+        strings_.swap(other.strings_);
+    }
+
+private:
+    typedef boost::unordered_map<std::string, Id> IndexMap;
+
+    IndexMap index_;
+    std::vector<const std::string *> strings_;
+};
+
+// the rules with their position in the run, see Rules::getCurrentRank, stored
+// once and referenced by their index, so that the reports don't carry the rank
+class RankedRuleTable
+{
+public:
+    typedef boost::uint32_t Id;
+
+    struct RankedRule
+    {
+        StringTable::Id name_;
+        boost::int32_t rank_;
+    };
+
+    Id intern(StringTable::Id name, boost::int32_t rank)
+    {
+        const Key key(rank, name);
+        const IndexMap::const_iterator it = index_.find(key);
+        if (it != index_.end())
+        {
+            return it->second;
+        }
+        const Id id = static_cast<Id>(rules_.size());
+        index_[key] = id;
+        RankedRule rule;
+        rule.name_ = name;
+        rule.rank_ = rank;
+        rules_.push_back(rule);
+        return id;
+    }
+
+    const RankedRule & get(Id id) const
+    {
+        return rules_[id];
+    }
+
+    void swap(RankedRuleTable & other)
+    {
+        index_.swap(other.index_);
+        rules_.swap(other.rules_);
+    }
+
+private:
+    typedef std::pair<boost::int32_t, StringTable::Id> Key;
+    typedef std::map<Key, Id> IndexMap;
+
+    IndexMap index_;
+    std::vector<RankedRule> rules_;
+};
+
+// a single report, as a fixed size record of indexes in the tables
+struct SingleReport
+{
+    Vera::Structures::SourceFiles::FileId file_;
+    boost::int32_t line_;
+    RankedRuleTable::Id rule_;
+    StringTable::Id message_;
+};
+
+// the reports are kept in 16 bytes each
+BOOST_STATIC_ASSERT(sizeof(SingleReport) == 16);
+
+typedef std::vector<SingleReport> ReportCollection;
+
+StringTable ruleNames_;
+StringTable messageTexts_;
+RankedRuleTable rankedRules_;
 
-// for a single file (line number -> single report)
-typedef std::multimap<int, SingleReport> FileMessagesCollection;
+ReportCollection messages_;
 
-// for all reports
-typedef std::map<Vera::Plugins::Reports::FileName, FileMessagesCollection> MessagesCollection;
+// number of reports per file, indexed by the file id
+std::vector<boost::uint32_t> reportsPerFile_;
+int filesWithReports_;
 
-MessagesCollection messages_;
+// the reports are sorted lazily, when they are written
+bool sorted_;
 
 bool showRules_;
 bool vcFormat_;
 bool xmlReport_;
 std::string prefix_;
 
+// orders the reports by file name, line number then rank of the rule - the
+// reports of a rule on a single line are kept in the order they were added
+// thanks to the stable sort
+class ReportOrder
+{
+public:
+    ReportOrder(const std::vector<boost::uint32_t> & fileRanks)
+        : fileRanks_(fileRanks) {}
+
+    bool operator()(const SingleReport & left, const SingleReport & right) const
+    {
+        if (left.file_ != right.file_)
+        {
+            return fileRanks_[left.file_] < fileRanks_[right.file_];
+        }
+        if (left.line_ != right.line_)
+        {
+            return left.line_ < right.line_;
+        }
+        return rankedRules_.get(left.rule_).rank_ < rankedRules_.get(right.rule_).rank_;
+    }
+
+private:
+    const std::vector<boost::uint32_t> & fileRanks_;
+};
+
+class FileNameOrder
+{
+public:
+    bool operator()(boost::uint32_t left, boost::uint32_t right) const
+    {
+        return Vera::Structures::SourceFiles::getFileName(left)
+            < Vera::Structures::SourceFiles::getFileName(right);
+    }
+};
+
+void sortReports()
+{
+    if (sorted_)
+    {
+        return;
+    }
+
+    std::vector<boost::uint32_t> files(Vera::Structures::SourceFiles::getFileIdCount());
+    for (boost::uint32_t i = 0; i != files.size(); ++i)
+    {
+        files[i] = i;
+    }
+    std::sort(files.begin(), files.end(), FileNameOrder());
+
+    std::vector<boost::uint32_t> fileRanks(files.size());
+    for (boost::uint32_t i = 0; i != files.size(); ++i)
+    {
+        fileRanks[files[i]] = i;
+    }
+
+    std::stable_sort(messages_.begin(), messages_.end(), ReportOrder(fileRanks));
+    sorted_ = true;
+}
+
+const Vera::Plugins::Rules::RuleName & getRuleName(const SingleReport & report)
+{
+    return ruleNames_.get(rankedRules_.get(report.rule_).name_);
+}
+
+bool isSameReport(const SingleReport & left, const SingleReport & right)
+{
+    return left.file_ == right.file_ && left.line_ == right.line_
+        && rankedRules_.get(left.rule_).name_ == rankedRules_.get(right.rule_).name_
+        && left.message_ == right.message_;
+}
+
+// the duplicates are adjacent once the reports are sorted
+bool isDuplicate(ReportCollection::const_iterator it, bool omitDuplicates)
+{
+    return omitDuplicates && it != messages_.begin() && isSameReport(*it, *(it - 1));
+}
+
+bool isFirstInFile(ReportCollection::const_iterator it)
+{
+    return it == messages_.begin() || it->file_ != (it - 1)->file_;
+}
+
+bool isLastInFile(ReportCollection::const_iterator it)
+{
+    return it + 1 == messages_.end() || it->file_ != (it + 1)->file_;
+}
+
+typedef boost::shared_ptr<Vera::Plugins::ReportWriter> WriterPtr;
+typedef std::vector<WriterPtr> WriterCollection;
+
+// the reports given to the writers, which don't share their streams
+void writePass(const WriterCollection & writers,
+    const Vera::Plugins::ReportWriter::RuleNameCollection & rules, bool omitDuplicates)
+{
+    const WriterCollection::const_iterator wbegin = writers.begin();
+    const WriterCollection::const_iterator wend = writers.end();
+    for (WriterCollection::const_iterator wit = wbegin; wit != wend; ++wit)
+    {
+        (*wit)->begin(rules);
+    }
+
+    for (ReportCollection::const_iterator it = messages_.begin(), end = messages_.end();
+         it != end; ++it)
+    {
+        const Vera::Plugins::Reports::FileName & name =
+            Vera::Structures::SourceFiles::getFileName(it->file_);
+        if (isFirstInFile(it))
+        {
+            for (WriterCollection::const_iterator wit = wbegin; wit != wend; ++wit)
+            {
+                (*wit)->beginFile(name);
+            }
+        }
+
+        if (isDuplicate(it, omitDuplicates) == false)
+        {
+            const Vera::Plugins::Rules::RuleName & rule = getRuleName(*it);
+            const Vera::Plugins::Reports::Message & msg = messageTexts_.get(it->message_);
+            for (WriterCollection::const_iterator wit = wbegin; wit != wend; ++wit)
+            {
+                (*wit)->report(name, it->line_, rule, msg);
+            }
+        }
+
+        if (isLastInFile(it))
+        {
+            for (WriterCollection::const_iterator wit = wbegin; wit != wend; ++wit)
+            {
+                (*wit)->endFile();
+            }
+        }
+    }
+
+    for (WriterCollection::const_iterator wit = wbegin; wit != wend; ++wit)
+    {
+        (*wit)->end();
+        (*wit)->finish();
+    }
+}
+
+void store(const Vera::Plugins::Reports::FileName & name, int lineNumber,
+    const Vera::Plugins::Rules::RuleName & rule, const Vera::Plugins::Reports::Message & msg,
+    int rank)
+{
+    SingleReport report;
+    report.file_ = Vera::Structures::SourceFiles::getFileId(name);
+    report.line_ = static_cast<boost::int32_t>(lineNumber);
+    report.rule_ = rankedRules_.intern(ruleNames_.intern(rule),
+        static_cast<boost::int32_t>(rank));
+    report.message_ = messageTexts_.intern(msg);
+
+    if (static_cast<std::size_t>(report.file_) >= reportsPerFile_.size())
+    {
+        reportsPerFile_.resize(report.file_ + 1, 0);
+    }
+    if (reportsPerFile_[report.file_]++ == 0)
+    {
+        ++filesWithReports_;
+    }
+
+    messages_.push_back(report);
+    sorted_ = false;
+}
+
+// The partial reports start with the magic and the version of the format,
+// followed by the tables of the names of the files, of the rules and of the
+// messages, and by the reports as indexes in these tables. The integers are
+// 32 bit little endian, and the strings are preceded by their length.
+const char partialMagic[] = "VERAPART";
+const std::size_t partialMagicSize = sizeof(partialMagic) - 1;
+const boost::uint32_t partialVersion = 1;
+
+void writeUint(std::ostream & os, boost::uint32_t value)
+{
+    char bytes[4];
+    for (int i = 0; i != 4; ++i)
+    {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    os.write(bytes, 4);
+}
+
+void writeString(std::ostream & os, const std::string & s)
+{
+    writeUint(os, static_cast<boost::uint32_t>(s.size()));
+    os.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+class PartialReader
+{
+public:
+    PartialReader(std::istream & is, const std::string & name)
+        : is_(is), name_(name) {}
+
+    void readHeader()
+    {
+        char magic[partialMagicSize];
+        read(magic, partialMagicSize);
+        if (std::memcmp(magic, partialMagic, partialMagicSize) != 0
+            || readUint() != partialVersion)
+        {
+            invalid();
+        }
+    }
+
+    boost::uint32_t readUint()
+    {
+        char bytes[4];
+        read(bytes, 4);
+        boost::uint32_t value = 0;
+        for (int i = 3; i >= 0; --i)
+        {
+            value = (value << 8) | static_cast<unsigned char>(bytes[i]);
+        }
+        return value;
+    }
+
+    // read by chunks, so an invalid length fails at the end of the file
+    // instead of allocating the whole length
+    std::string readString()
+    {
+        boost::uint32_t length = readUint();
+        std::string s;
+        char chunk[4096];
+        while (length != 0)
+        {
+            const std::size_t size = std::min<std::size_t>(length, sizeof(chunk));
+            read(chunk, size);
+            s.append(chunk, size);
+            length -= static_cast<boost::uint32_t>(size);
+        }
+        return s;
+    }
+
+    std::vector<std::string> readTable()
+    {
+        std::vector<std::string> table(readUint());
+        for (std::size_t i = 0; i != table.size(); ++i)
+        {
+            table[i] = readString();
+        }
+        return table;
+    }
+
+    // the index must be in a table of the given size
+    boost::uint32_t readIndex(std::size_t size)
+    {
+        const boost::uint32_t index = readUint();
+        if (index >= size)
+        {
+            invalid();
+        }
+        return index;
+    }
+
+    void invalid()
+    {
+        throw Vera::Plugins::ReportsError("Invalid partial report " + name_);
+    }
+
+private:
+    void read(char * bytes, std::size_t size)
+    {
+        is_.read(bytes, static_cast<std::streamsize>(size));
+        if (static_cast<std::size_t>(is_.gcount()) != size)
+        {
+            throw Vera::Plugins::ReportsError("Truncated partial report " + name_);
+        }
+    }
+
+    std::istream & is_;
+    std::string name_;
+};
+
 } // unnamed namespace
 
 namespace Vera
@@ -63,7 +461,12 @@ void Reports::setPrefix(std::string prefix)
 
 int Reports::count()
 {
-    return messages_.size();
+    return static_cast<int>(messages_.size());
+}
+
+int Reports::countFiles()
+{
+    return filesWithReports_;
 }
 
 void Reports::add(const FileName & name, int lineNumber, const Message & msg)
@@ -74,10 +477,12 @@ void Reports::add(const FileName & name, int lineNumber, const Message & msg)
       ss << "Line number out of range: " << lineNumber;
       throw std::out_of_range(ss.str());
     }
+    CallStats::countReport();
     const Rules::RuleName currentRule = Rules::getCurrentRule();
-    if (Exclusions::isExcluded(name, lineNumber, currentRule, msg) == false)
+    if (Exclusions::isExcluded(name, lineNumber, currentRule, msg) == false
+        && Baseline::isKnown(name, lineNumber, currentRule) == false)
     {
-        messages_[name].insert(make_pair(lineNumber, make_pair(currentRule, msg)));
+        store(name, lineNumber, currentRule, msg, Rules::getCurrentRank());
     }
 }
 
@@ -85,7 +490,7 @@ void Reports::internal(const FileName & name, int lineNumber, const Message & ms
 {
     const Rules::RuleName currentRule = "vera++ internal";
 
-    messages_[name].insert(make_pair(lineNumber, make_pair(currentRule, msg)));
+    store(name, lineNumber, currentRule, msg, Rules::getCurrentRank());
 }
 
 void Reports::dumpAll(std::ostream & os, bool omitDuplicates)
@@ -102,58 +507,45 @@ void Reports::dumpAll(std::ostream & os, bool omitDuplicates)
 
 void Reports::dumpAllNormal(std::ostream & os, bool omitDuplicates)
 {
+    sortReports();
 
-    for (MessagesCollection::iterator it = messages_.begin(), end = messages_.end();
+    for (ReportCollection::const_iterator it = messages_.begin(), end = messages_.end();
          it != end; ++it)
     {
-        const FileName & name = it->first;
-
-        FileMessagesCollection & fileMessages = it->second;
+        if (isDuplicate(it, omitDuplicates))
+        {
+            continue;
+        }
 
-        FileMessagesCollection::iterator fit = fileMessages.begin();
-        FileMessagesCollection::iterator fend = fileMessages.end();
+        const FileName & name = Vera::Structures::SourceFiles::getFileName(it->file_);
+        const int lineNumber = it->line_;
+        const Rules::RuleName & rule = getRuleName(*it);
+        const Message & msg = messageTexts_.get(it->message_);
 
-        int lastLineNumber = 0;
-        SingleReport lastReport;
-        for ( ; fit != fend; ++fit)
+        if (showRules_)
         {
-            int lineNumber = fit->first;
-            const SingleReport & report = fit->second;
-            const Rules::RuleName & rule = report.first;
-            const Message & msg = report.second;
-
-            if (omitDuplicates == false ||
-                lineNumber != lastLineNumber || report != lastReport)
+            if (vcFormat_)
+            {
+                os << name << '(' << lineNumber << ") : "
+                    << '(' << rule << ") " << msg << '\n';
+            }
+            else
             {
-                if (showRules_)
-                {
-                    if (vcFormat_)
-                    {
-                        os << name << '(' << lineNumber << ") : "
-                            << '(' << rule << ") " << msg << '\n';
-                    }
-                    else
-                    {
-                        os << name << ':' << lineNumber << ": "
-                            << '(' << rule << ") " << msg << '\n';
-                    }
-                }
-                else
-                {
-                    if (vcFormat_)
-                    {
-                        os << name << '(' << lineNumber << ") : "
-                            << msg << '\n';
-                    }
-                    else
-                    {
-                        os << name << ':' << lineNumber << ": "
-                            << msg << '\n';
-                    }
-                }
-
-                lastLineNumber = lineNumber;
-                lastReport = report;
+                os << name << ':' << lineNumber << ": "
+                    << '(' << rule << ") " << msg << '\n';
+            }
+        }
+        else
+        {
+            if (vcFormat_)
+            {
+                os << name << '(' << lineNumber << ") : "
+                    << msg << '\n';
+            }
+            else
+            {
+                os << name << ':' << lineNumber << ": "
+                    << msg << '\n';
             }
         }
     }
@@ -166,212 +558,249 @@ void Reports::dumpAllXML(std::ostream & os, bool omitDuplicates)
 
 void Reports::writeStd(std::ostream & os, bool omitDuplicates)
 {
+    write(OutputCollection(1, Output(standard, os)), omitDuplicates);
+}
 
-    for (MessagesCollection::iterator it = messages_.begin(), end = messages_.end();
-         it != end; ++it)
-    {
-        const FileName & name = it->first;
+void Reports::writeVc(std::ostream & os, bool omitDuplicates)
+{
+    write(OutputCollection(1, Output(visualc, os)), omitDuplicates);
+}
 
-        FileMessagesCollection & fileMessages = it->second;
+void Reports::writeXml(std::ostream & os, bool omitDuplicates)
+{
+    write(OutputCollection(1, Output(xml, os)), omitDuplicates);
+}
 
-        FileMessagesCollection::iterator fit = fileMessages.begin();
-        FileMessagesCollection::iterator fend = fileMessages.end();
+void Reports::writeCheckStyle(std::ostream & os, bool omitDuplicates)
+{
+    write(OutputCollection(1, Output(checkstyle, os)), omitDuplicates);
+}
 
-        int lastLineNumber = 0;
-        SingleReport lastReport;
-        for ( ; fit != fend; ++fit)
+void Reports::write(const OutputCollection & outputs, bool omitDuplicates)
+{
+    // The writers of a stream run one after the other, each one in its own
+    // pass over the reports, so that every writer streams its output in blocks
+    // instead of keeping it until the previous writers of its stream are done.
+    std::vector<WriterCollection> passes;
+    for (OutputCollection::const_iterator it = outputs.begin(), end = outputs.end();
+         it != end; ++it)
+    {
+        WriterPtr writer;
+        switch (it->format_)
         {
-            int lineNumber = fit->first;
-            const SingleReport & report = fit->second;
-            const Rules::RuleName & rule = report.first;
-            const Message & msg = report.second;
+        case standard:
+            writer.reset(new StdReportWriter(*it->stream_, prefix_, showRules_));
+            break;
+        case visualc:
+            writer.reset(new VcReportWriter(*it->stream_, prefix_, showRules_));
+            break;
+        case xml:
+            writer.reset(new XmlReportWriter(*it->stream_, prefix_, showRules_));
+            break;
+        case checkstyle:
+            writer.reset(new CheckStyleReportWriter(*it->stream_, prefix_, showRules_));
+            break;
+        case sarif:
+            writer.reset(new SarifReportWriter(*it->stream_, prefix_, showRules_));
+            break;
+        case jsonlines:
+            writer.reset(new JsonLinesReportWriter(*it->stream_, prefix_, showRules_));
+            break;
+        }
 
-            if (omitDuplicates == false ||
-                lineNumber != lastLineNumber || report != lastReport)
+        // the pass after the one of the last writer of the same stream
+        std::size_t pass = 0;
+        for (OutputCollection::const_iterator oit = outputs.begin(); oit != it; ++oit)
+        {
+            if (oit->stream_ == it->stream_)
             {
-                os << name;
-                os << ':' << lineNumber << ":";
-                if (prefix_ != "")
-                {
-                    os << " " << prefix_;
-                }
-                if (showRules_)
-                {
-                    os << " " << rule;
-                }
-                if (showRules_ || prefix_ != "")
-                {
-                    os << ":";
-                }
-                os << " " << msg << std::endl;
-
-                lastLineNumber = lineNumber;
-                lastReport = report;
+                ++pass;
             }
         }
+        if (pass == passes.size())
+        {
+            passes.push_back(WriterCollection());
+        }
+        passes[pass].push_back(writer);
     }
-}
 
-void Reports::writeVc(std::ostream & os, bool omitDuplicates)
-{
+    sortReports();
 
-    for (MessagesCollection::iterator it = messages_.begin(), end = messages_.end();
-         it != end; ++it)
+    ReportWriter::RuleNameCollection rules;
+    for (StringTable::Id id = 0; id != ruleNames_.size(); ++id)
     {
-        const FileName & name = it->first;
+        rules.push_back(ruleNames_.get(id));
+    }
 
-        FileMessagesCollection & fileMessages = it->second;
+    for (std::size_t pass = 0; pass != passes.size(); ++pass)
+    {
+        writePass(passes[pass], rules, omitDuplicates);
+    }
+}
 
-        FileMessagesCollection::iterator fit = fileMessages.begin();
-        FileMessagesCollection::iterator fend = fileMessages.end();
+Reports::RecordCollection Reports::getAll(bool omitDuplicates)
+{
+    sortReports();
 
-        int lastLineNumber = 0;
-        SingleReport lastReport;
-        for ( ; fit != fend; ++fit)
+    RecordCollection res;
+    res.reserve(messages_.size());
+    for (std::size_t i = 0; i != messages_.size(); ++i)
+    {
+        if (isDuplicate(messages_.begin() + i, omitDuplicates) == false)
         {
-            int lineNumber = fit->first;
-            const SingleReport & report = fit->second;
-            const Rules::RuleName & rule = report.first;
-            const Message & msg = report.second;
-
-            if (omitDuplicates == false ||
-                lineNumber != lastLineNumber || report != lastReport)
-            {
-                os << name;
-                os << '(' << lineNumber << "):";
-                if (prefix_ != "")
-                {
-                    os << " " << prefix_;
-                }
-                if (showRules_)
-                {
-                    os << " " << rule;
-                }
-                if (showRules_ || prefix_ != "")
-                {
-                    os << ":";
-                }
-                os << " " << msg << std::endl;
-
-                lastLineNumber = lineNumber;
-                lastReport = report;
-            }
+            Record report;
+            report.fileName_ = Structures::SourceFiles::getFileName(messages_[i].file_);
+            report.lineNumber_ = messages_[i].line_;
+            report.rule_ = getRuleName(messages_[i]);
+            report.message_ = messageTexts_.get(messages_[i].message_);
+            res.push_back(report);
         }
     }
+    return res;
 }
 
-void Reports::writeXml(std::ostream & os, bool omitDuplicates)
+void Reports::writePartial(std::ostream & os)
 {
-    os<< "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
-    os << "<vera>\n";
-
-    for (MessagesCollection::iterator it = messages_.begin(), end = messages_.end();
-         it != end; ++it)
+    // the reports are written in their final order, which the merge keeps
+    sortReports();
+
+    os.write(partialMagic, static_cast<std::streamsize>(partialMagicSize));
+    writeUint(os, partialVersion);
+
+    // the files checked or with reports, and not the ones only named by the
+    // exclusions or the baseline, which may be checked by another shard
+    const Structures::SourceFiles::FileNameSet & checked =
+        Structures::SourceFiles::getAllFileNames();
+    std::vector<boost::uint32_t> fileIndexes(Structures::SourceFiles::getFileIdCount());
+    FileNameCollection files;
+    for (std::size_t id = 0; id != fileIndexes.size(); ++id)
     {
-        const FileName & name = it->first;
-
-        os << "    <file name=\"" << name << "\">\n";
-
-        FileMessagesCollection & fileMessages = it->second;
-
-        FileMessagesCollection::iterator fit = fileMessages.begin();
-        FileMessagesCollection::iterator fend = fileMessages.end();
-
-        int lastLineNumber = 0;
-        SingleReport lastReport;
-        for ( ; fit != fend; ++fit)
+        const FileName & name = Structures::SourceFiles::getFileName(static_cast<int>(id));
+        if (checked.count(name) != 0
+            || (id < reportsPerFile_.size() && reportsPerFile_[id] != 0))
         {
-            int lineNumber = fit->first;
-            const SingleReport & report = fit->second;
-            const Rules::RuleName & rule = report.first;
-            const Message & msg = report.second;
-
-            if (omitDuplicates == false ||
-                lineNumber != lastLineNumber || report != lastReport)
-            {
-                if (showRules_)
-                {
-                    os << "        <report rule=\"" << xmlEscape(rule)
-                        << "\" line=\"" << lineNumber
-                        << "\">![CDATA[" << msg << "]]</report>\n";
-                }
-                else
-                {
-                    os << "        <report line=\"" << lineNumber
-                        << "\">![CDATA[" << msg << "]]</report>\n";
-                }
-
-                lastLineNumber = lineNumber;
-                lastReport = report;
-            }
+            fileIndexes[id] = static_cast<boost::uint32_t>(files.size());
+            files.push_back(name);
         }
-
-        os << "    </file>\n";
     }
 
-    os << "</vera>\n";
-}
-
-void Reports::writeCheckStyle(std::ostream & os, bool omitDuplicates)
-{
-    std::string severity = prefix_;
-    if (severity == "")
+    writeUint(os, static_cast<boost::uint32_t>(files.size()));
+    for (std::size_t i = 0; i != files.size(); ++i)
     {
-        severity = "info";
+        writeString(os, files[i]);
+    }
+    writeUint(os, ruleNames_.size());
+    for (StringTable::Id id = 0; id != ruleNames_.size(); ++id)
+    {
+        writeString(os, ruleNames_.get(id));
+    }
+    writeUint(os, messageTexts_.size());
+    for (StringTable::Id id = 0; id != messageTexts_.size(); ++id)
+    {
+        writeString(os, messageTexts_.get(id));
     }
-    os<< "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
-    os << "<checkstyle version=\"5.0\">\n";
 
-    for (MessagesCollection::iterator it = messages_.begin(), end = messages_.end();
+    writeUint(os, static_cast<boost::uint32_t>(messages_.size()));
+    for (ReportCollection::const_iterator it = messages_.begin(), end = messages_.end();
          it != end; ++it)
     {
-        const FileName & name = it->first;
-
-        os << "    <file name=\"" << name << "\">\n";
+        writeUint(os, fileIndexes[it->file_]);
+        writeUint(os, static_cast<boost::uint32_t>(it->line_));
+        writeUint(os, rankedRules_.get(it->rule_).name_);
+        writeUint(os, it->message_);
+    }
+}
 
-        FileMessagesCollection & fileMessages = it->second;
+void Reports::merge(const FileNameCollection & names)
+{
+    std::set<FileName> mergedFiles;
+    for (FileNameCollection::const_iterator it = names.begin(); it != names.end(); ++it)
+    {
+        std::ifstream file(it->c_str(), std::ios::in | std::ios::binary);
+        if (file.is_open() == false)
+        {
+            throw ReportsError(
+                "Cannot open partial report " + *it + ": " + strerror(errno));
+        }
 
-        FileMessagesCollection::iterator fit = fileMessages.begin();
-        FileMessagesCollection::iterator fend = fileMessages.end();
+        PartialReader reader(file, *it);
+        reader.readHeader();
+        const FileNameCollection files = reader.readTable();
+        const std::vector<std::string> rules = reader.readTable();
+        const std::vector<std::string> messages = reader.readTable();
 
-        int lastLineNumber = 0;
-        SingleReport lastReport;
-        for ( ; fit != fend; ++fit)
+        std::vector<bool> skipped(files.size());
+        for (std::size_t i = 0; i != files.size(); ++i)
         {
-            int lineNumber = fit->first;
-            const SingleReport & report = fit->second;
-            const Rules::RuleName & rule = report.first;
-            const Message & msg = report.second;
+            skipped[i] = mergedFiles.count(files[i]) != 0;
+        }
 
-            if (omitDuplicates == false ||
-                lineNumber != lastLineNumber || report != lastReport)
+        const boost::uint32_t count = reader.readUint();
+        for (boost::uint32_t i = 0; i != count; ++i)
+        {
+            const boost::uint32_t fileIndex = reader.readIndex(files.size());
+            const boost::uint32_t lineNumber = reader.readUint();
+            const boost::uint32_t rule = reader.readIndex(rules.size());
+            const boost::uint32_t message = reader.readIndex(messages.size());
+            if (lineNumber == 0 || lineNumber > 0x7fffffffu)
+            {
+                reader.invalid();
+            }
+            if (skipped[fileIndex] == false)
             {
-                os << "        <error source=\"" << xmlEscape(rule)
-                    << "\" severity=\"" << xmlEscape(severity)
-                    << "\" line=\"" << lineNumber
-                    << "\" message=\"" << xmlEscape(msg)
-                    << "\" />\n";
-
-                lastLineNumber = lineNumber;
-                lastReport = report;
+                store(files[fileIndex], static_cast<int>(lineNumber),
+                    rules[rule], messages[message], 0);
             }
         }
 
-        os << "    </file>\n";
+        for (std::size_t i = 0; i != files.size(); ++i)
+        {
+            if (skipped[i] == false)
+            {
+                Structures::SourceFiles::addFileName(files[i]);
+                mergedFiles.insert(files[i]);
+            }
+        }
     }
+}
 
-    os << "</checkstyle>\n";
+struct Reports::State
+{
+    State()
+        : filesWithReports_(0), sorted_(false), showRules_(false), vcFormat_(false),
+        xmlReport_(false) {}
+
+    StringTable ruleNames_;
+    StringTable messageTexts_;
+    RankedRuleTable rankedRules_;
+    ReportCollection messages_;
+    std::vector<boost::uint32_t> reportsPerFile_;
+    int filesWithReports_;
+    bool sorted_;
+    bool showRules_;
+    bool vcFormat_;
+    bool xmlReport_;
+    std::string prefix_;
+};
+
+boost::shared_ptr<Reports::State> Reports::createState()
+{
+    return boost::shared_ptr<State>(new State());
 }
 
-std::string Reports::xmlEscape(const std::string & msg)
+void Reports::swapState(State & state)
 {
-    std::string res = msg;
-    boost::algorithm::replace_all(res, "&",  "&amp;");
-    boost::algorithm::replace_all(res, "\"", "&quot;");
-    boost::algorithm::replace_all(res, "\'", "&apos;");
-    boost::algorithm::replace_all(res, "<",  "&lt;");
-    boost::algorithm::replace_all(res, ">",  "&gt;");
-    return res;
+    ruleNames_.swap(state.ruleNames_);
+    messageTexts_.swap(state.messageTexts_);
+    rankedRules_.swap(state.rankedRules_);
+    messages_.swap(state.messages_);
+    reportsPerFile_.swap(state.reportsPerFile_);
+    std::swap(filesWithReports_, state.filesWithReports_);
+    std::swap(sorted_, state.sorted_);
+    std::swap(showRules_, state.showRules_);
+    std::swap(vcFormat_, state.vcFormat_);
+    std::swap(xmlReport_, state.xmlReport_);
+    prefix_.swap(state.prefix_);
 }
 
 }
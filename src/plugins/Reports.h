@@ -10,7 +10,10 @@
 
 #include "Reports.h"
 #include <string>
+#include <vector>
 #include <ostream>
+#include <stdexcept>
+#include <boost/shared_ptr.hpp>
 
 
 namespace Vera
@@ -18,6 +21,11 @@ namespace Vera
 namespace Plugins
 {
 
+class ReportsError : public std::runtime_error
+{
+public:
+    ReportsError(const std::string & msg) : std::runtime_error(msg) {}
+};
 
 class Reports
 {
@@ -25,12 +33,37 @@ public:
     typedef std::string FileName;
     typedef std::string Message;
 
+    enum Format { standard, visualc, xml, checkstyle, sarif, jsonlines };
+
+    struct Output
+    {
+        Output(Format format, std::ostream & os) : format_(format), stream_(&os) {}
+
+        Format format_;
+        std::ostream * stream_;
+    };
+
+    typedef std::vector<Output> OutputCollection;
+
+    struct Record
+    {
+        FileName fileName_;
+        int lineNumber_;
+        std::string rule_;
+        Message message_;
+    };
+
+    typedef std::vector<Record> RecordCollection;
+
+    typedef std::vector<FileName> FileNameCollection;
+
     static void setShowRules(bool show);
     static void setVCFormat(bool vc);
     static void setXMLReport(bool xmlReport);
     static void setPrefix(std::string prefix);
 
     static int count();
+    static int countFiles();
 
     static void add(const FileName & name, int lineNumber, const Message & msg);
     static void internal(const FileName & name, int lineNumber,
@@ -43,10 +76,30 @@ public:
     static void writeXml(std::ostream & os, bool omitDuplicates);
     static void writeCheckStyle(std::ostream & os, bool omitDuplicates);
 
+    // the outputs in a single pass over the reports, with one more pass for
+    // each output on a stream already used by another one
+    static void write(const OutputCollection & outputs, bool omitDuplicates);
+
+    // sorted as they are written
+    static RecordCollection getAll(bool omitDuplicates);
+
+    // The reports and the files checked, in a compact binary form, for the
+    // run of a shard: the partial reports of the shards are then merged.
+    static void writePartial(std::ostream & os);
+
+    // Adds the reports of the partial report files, in order. The files of a
+    // partial report already found in a previous one are skipped, so a shard
+    // given twice is only counted once.
+    static void merge(const FileNameCollection & names);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
+
 private:
     static void dumpAllNormal(std::ostream & os, bool omitDuplicates);
     static void dumpAllXML(std::ostream & os, bool omitDuplicates);
-    static std::string xmlEscape(const std::string & msg);
 };
 
 } // namespace Plugins
@@ -30,5 +30,20 @@ RootDirectory::DirectoryName RootDirectory::getRootDirectory()
     return root_;
 }
 
+struct RootDirectory::State
+{
+    DirectoryName root_;
+};
+
+boost::shared_ptr<RootDirectory::State> RootDirectory::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void RootDirectory::swapState(State & state)
+{
+    root_.swap(state.root_);
+}
+
 }
 }
@@ -9,6 +9,7 @@
 #define ROOTDIRECTORY_H_INCLUDED
 
 #include <string>
+#include <boost/shared_ptr.hpp>
 
 
 namespace Vera
@@ -25,6 +26,11 @@ public:
     static void setRootDirectory(const DirectoryName & name);
 
     static DirectoryName getRootDirectory();
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
 };
 
 } // namespace Plugins
@@ -8,6 +8,18 @@
 #include "Rules.h"
 #include "RootDirectory.h"
 #include "Interpreter.h"
+#include "ScriptCatalog.h"
+#include "Exclusions.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "../structures/SourceFiles.h"
+#include "../structures/SourceLines.h"
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <algorithm>
+#include <sstream>
+
+#define foreach BOOST_FOREACH
 
 
 namespace // unnamed
@@ -15,6 +27,53 @@ namespace // unnamed
 
 Vera::Plugins::Rules::RuleName currentRule_;
 
+// the position of the current rule among the rules run together
+int currentRank_ = 0;
+
+typedef std::vector<Vera::Plugins::Exclusions::FileNameCollection> BatchCollection;
+
+// the memory used by the lines of the file, and by its tokens, from its size
+// (the buffers are never unloaded, so they don't count)
+std::size_t estimateMemory(const Vera::Structures::SourceFiles::FileName & name, bool tokens)
+{
+    if (Vera::Structures::SourceLines::isBuffer(Vera::Structures::SourceFiles::getFileId(name)))
+    {
+        return 0;
+    }
+
+    boost::system::error_code ec;
+    const boost::uintmax_t size = boost::filesystem::file_size(name, ec);
+    if (ec)
+    {
+        return 0;
+    }
+
+    // the lines take about twice the size of the file, and the tokens five times
+    return static_cast<std::size_t>(size) * (tokens ? 7 : 2);
+}
+
+BatchCollection makeBatches(bool tokens)
+{
+    const std::size_t maxMemory = Vera::Structures::SourceLines::getMaxMemory();
+
+    BatchCollection batches(1);
+    std::size_t batchMemory = 0;
+    foreach (const Vera::Structures::SourceFiles::FileName & name,
+        Vera::Structures::SourceFiles::getAllFileNames())
+    {
+        const std::size_t memory = estimateMemory(name, tokens);
+        if (maxMemory != 0 && batches.back().empty() == false
+            && batchMemory + memory > maxMemory)
+        {
+            batches.push_back(Vera::Plugins::Exclusions::FileNameCollection());
+            batchMemory = 0;
+        }
+        batches.back().push_back(name);
+        batchMemory += memory;
+    }
+    return batches;
+}
+
 } // unnamed namespace
 
 namespace Vera
@@ -22,13 +81,154 @@ namespace Vera
 namespace Plugins
 {
 
+Rules::Manifest Rules::getManifest(const RuleName & name)
+{
+    std::istringstream file(ScriptCatalog::find(
+        RootDirectory::getRootDirectory(), Interpreter::rule, name).body_);
+
+    // the comments at the top of the script, in Tcl, Python or Lua
+    Manifest manifest;
+    std::string line;
+    while (getline(file, line))
+    {
+        std::string::size_type begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos)
+        {
+            continue;
+        }
+        if (line.compare(begin, 1, "#") == 0)
+        {
+            begin += 1;
+        }
+        else if (line.compare(begin, 2, "--") == 0)
+        {
+            begin += 2;
+        }
+        else
+        {
+            break;
+        }
+
+        std::istringstream comment(line.substr(begin));
+        std::string key;
+        std::string value;
+        comment >> key;
+        if (key == "needs:")
+        {
+            while (comment >> value)
+            {
+                if (value == "tokens")
+                {
+                    manifest.needsTokens_ = true;
+                }
+                else if (value != "names" && value != "lines")
+                {
+                    throw ScriptError("unknown data needed by the rule " + name + ": " + value);
+                }
+            }
+        }
+        else if (key == "scope:")
+        {
+            comment >> value;
+            if (value == "file")
+            {
+                manifest.perFile_ = true;
+            }
+            else if (value != "all")
+            {
+                throw ScriptError("unknown scope of the rule " + name + ": " + value);
+            }
+        }
+    }
+
+    return manifest;
+}
+
 void Rules::executeRule(const RuleName & name)
 {
     currentRule_ = name;
 
     const Vera::Plugins::RootDirectory::DirectoryName veraRoot =
             Vera::Plugins::RootDirectory::getRootDirectory();
+    Trace::Span span("rule", name);
+    Profiler::startRule(name);
     Interpreter::execute(veraRoot, Interpreter::rule, name);
+    Profiler::stopRule();
+}
+
+void Rules::executeRules(const RuleNameCollection & declarations)
+{
+    RuleNameCollection names;
+    std::vector<Manifest> manifests;
+    bool tokensNeeded = false;
+    foreach (const RuleName & declaration, declarations)
+    {
+        std::istringstream words(declaration);
+        RuleName name;
+        if (words >> name)
+        {
+            names.push_back(name);
+            manifests.push_back(getManifest(name));
+
+            // the data declared with the rule replaces the one of its manifest
+            Manifest & manifest = manifests.back();
+            std::string data;
+            for (bool first = true; words >> data; first = false)
+            {
+                if (first)
+                {
+                    manifest.needsTokens_ = false;
+                }
+                if (data == "tokens")
+                {
+                    manifest.needsTokens_ = true;
+                }
+                else if (data != "names" && data != "lines")
+                {
+                    throw ScriptError("unknown data needed by the rule " + name + ": " + data);
+                }
+            }
+            tokensNeeded = tokensNeeded || manifest.needsTokens_;
+        }
+    }
+    Structures::SourceLines::setParseOnLoad(tokensNeeded);
+    Structures::SourceLines::parseBuffers();
+
+    const BatchCollection batches = makeBatches(tokensNeeded);
+    if (batches.size() <= 1)
+    {
+        for (RuleNameCollection::size_type i = 0; i != names.size(); ++i)
+        {
+            currentRank_ = static_cast<int>(i);
+            executeRule(names[i]);
+        }
+        currentRank_ = 0;
+        return;
+    }
+
+    foreach (const Exclusions::FileNameCollection & batch, batches)
+    {
+        Exclusions::setBatch(batch);
+        for (RuleNameCollection::size_type i = 0; i != names.size(); ++i)
+        {
+            if (manifests[i].perFile_)
+            {
+                currentRank_ = static_cast<int>(i);
+                executeRule(names[i]);
+            }
+        }
+    }
+    Exclusions::setBatch(Exclusions::FileNameCollection());
+
+    for (RuleNameCollection::size_type i = 0; i != names.size(); ++i)
+    {
+        if (manifests[i].perFile_ == false)
+        {
+            currentRank_ = static_cast<int>(i);
+            executeRule(names[i]);
+        }
+    }
+    currentRank_ = 0;
 }
 
 Rules::RuleName Rules::getCurrentRule()
@@ -36,5 +236,29 @@ Rules::RuleName Rules::getCurrentRule()
     return currentRule_;
 }
 
+int Rules::getCurrentRank()
+{
+    return currentRank_;
+}
+
+struct Rules::State
+{
+    State() : currentRank_(0) {}
+
+    RuleName currentRule_;
+    int currentRank_;
+};
+
+boost::shared_ptr<Rules::State> Rules::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void Rules::swapState(State & state)
+{
+    currentRule_.swap(state.currentRule_);
+    std::swap(currentRank_, state.currentRank_);
+}
+
 }
 }
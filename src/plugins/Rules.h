@@ -9,6 +9,8 @@
 #define RULES_H_INCLUDED
 
 #include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 
 
 namespace Vera
@@ -20,10 +22,45 @@ class Rules
 {
 public:
     typedef std::string RuleName;
+    typedef std::vector<RuleName> RuleNameCollection;
+
+    // Declared by the comments at the top of the script of the rule, as in
+    //   # needs: lines tokens
+    //   # scope: file
+    // where the data is among names, lines and tokens. A rule of the file scope
+    // checks each file on its own, while a rule of the all scope, the default,
+    // can look at several files together.
+    struct Manifest
+    {
+        Manifest() : needsTokens_(false), perFile_(false) {}
+
+        bool needsTokens_;
+        bool perFile_;
+    };
+
+    static Manifest getManifest(const RuleName & name);
 
     static void executeRule(const RuleName & name);
 
+    // A rule can be followed by the data it needs, as in "L001 lines" in a
+    // profile, which is then used instead of the data of its manifest.
+    //
+    // With a memory limit, the rules of the file scope are run together on
+    // batches of files that fit in the limit, so that each file is loaded
+    // once, and the other rules are run after them on all the files.
+    static void executeRules(const RuleNameCollection & declarations);
+
     static RuleName getCurrentRule();
+
+    // The position of the current rule among the rules given to executeRules,
+    // which orders the reports of a line whether the rules run in batches or
+    // not.
+    static int getCurrentRank();
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
 };
 
 } // namespace Plugins
@@ -0,0 +1,241 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "ScriptCatalog.h"
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+
+namespace // unnamed
+{
+
+typedef Vera::Plugins::ScriptCatalog::Script Script;
+
+// by the name of the file in its directory, with its extension
+typedef std::map<std::string, Script> ScriptMap;
+
+// the scanned directories, with their time of modification
+typedef std::map<std::string, std::time_t> DirectoryMap;
+
+struct Catalog
+{
+    Catalog() : scanned_(false) {}
+
+    bool scanned_;
+    std::string scriptsDirectory_;
+    std::string rootDirectory_;
+    ScriptMap scripts_;
+    DirectoryMap directories_;
+};
+
+// by the directory of the type in the root
+typedef std::map<std::string, Catalog> CatalogMap;
+
+CatalogMap catalogs;
+bool hotReload = false;
+
+struct Extension
+{
+    const char * extension_;
+    Vera::Plugins::ScriptCatalog::Language language_;
+};
+
+// in the order the languages are looked for
+const Extension extensions[] =
+{
+    { ".tcl", Vera::Plugins::ScriptCatalog::tcl },
+#ifdef VERA_PYTHON
+    { ".py", Vera::Plugins::ScriptCatalog::python },
+#endif
+#ifdef VERA_LUA
+    { ".lua", Vera::Plugins::ScriptCatalog::lua },
+#endif
+};
+
+const std::size_t extensionCount = sizeof(extensions) / sizeof(extensions[0]);
+
+// -1 for a missing file, so its creation is seen as a modification
+std::time_t modificationTime(const std::string & path)
+{
+    boost::system::error_code ec;
+    const std::time_t time = boost::filesystem::last_write_time(path, ec);
+    return ec ? static_cast<std::time_t>(-1) : time;
+}
+
+// the scripts already in the catalog hide the ones of the directory
+void addScript(Catalog & catalog, const std::string & key, const std::string & path,
+    Vera::Plugins::ScriptCatalog::Language language)
+{
+    Script script;
+    script.fileName_ = path;
+    script.language_ = language;
+    script.modified_ = modificationTime(path);
+    script.read_ = false;
+    catalog.scripts_.insert(std::make_pair(key, script));
+}
+
+void scan(const std::string & directory, Catalog & catalog)
+{
+    catalog.directories_[directory] = modificationTime(directory);
+
+    boost::system::error_code ec;
+    if (boost::filesystem::is_directory(directory, ec) == false)
+    {
+        return;
+    }
+
+    // the symbolic links to directories are followed, as the probes did
+    const boost::filesystem::recursive_directory_iterator end;
+    for (boost::filesystem::recursive_directory_iterator it(directory,
+             boost::filesystem::symlink_option::recurse, ec);
+         it != end; it.increment(ec))
+    {
+        if (ec)
+        {
+            break;
+        }
+
+        const std::string path = it->path().generic_string();
+        if (boost::filesystem::is_directory(it->status()))
+        {
+            catalog.directories_[path] = modificationTime(path);
+            continue;
+        }
+
+        for (std::size_t i = 0; i != extensionCount; ++i)
+        {
+            if (boost::algorithm::ends_with(path, extensions[i].extension_))
+            {
+                addScript(catalog, path.substr(directory.size()), path, extensions[i].language_);
+            }
+        }
+    }
+}
+
+bool isModified(const Catalog & catalog)
+{
+    for (DirectoryMap::const_iterator it = catalog.directories_.begin();
+         it != catalog.directories_.end(); ++it)
+    {
+        if (modificationTime(it->first) != it->second)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+Catalog & getCatalog(const Vera::Plugins::Interpreter::DirectoryName & root,
+    Vera::Plugins::Interpreter::ScriptType type)
+{
+    const std::string typeDirectory =
+        type == Vera::Plugins::Interpreter::rule ? "rules/" : "transformations/";
+    const std::string scriptsDirectory = root + "/scripts/" + typeDirectory;
+    const std::string rootDirectory = root + "/" + typeDirectory;
+
+    Catalog & catalog = catalogs[rootDirectory];
+    if (catalog.scanned_ && hotReload && isModified(catalog))
+    {
+        catalog = Catalog();
+    }
+    if (catalog.scanned_ == false)
+    {
+        catalog.scriptsDirectory_ = scriptsDirectory;
+        catalog.rootDirectory_ = rootDirectory;
+        scan(scriptsDirectory, catalog);
+        scan(rootDirectory, catalog);
+        catalog.scanned_ = true;
+    }
+    return catalog;
+}
+
+// A name not found by the scan, such as a path out of the directories of the
+// root: the disk is probed as before the catalog, and the script found is
+// added to the catalog.
+ScriptMap::iterator probe(Catalog & catalog, const std::string & fileName,
+    Vera::Plugins::ScriptCatalog::Language language)
+{
+    const std::string directories[] = { catalog.scriptsDirectory_, catalog.rootDirectory_ };
+    for (std::size_t i = 0; i != 2; ++i)
+    {
+        boost::system::error_code ec;
+        if (boost::filesystem::exists(directories[i] + fileName, ec))
+        {
+            addScript(catalog, fileName, directories[i] + fileName, language);
+            return catalog.scripts_.find(fileName);
+        }
+    }
+    return catalog.scripts_.end();
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Plugins
+{
+
+const ScriptCatalog::Script & ScriptCatalog::find(const Interpreter::DirectoryName & root,
+    Interpreter::ScriptType type, const Interpreter::ScriptName & name)
+{
+    Catalog & catalog = getCatalog(root, type);
+
+    ScriptMap::iterator it = catalog.scripts_.end();
+    for (std::size_t i = 0; i != extensionCount && it == catalog.scripts_.end(); ++i)
+    {
+        const std::string fileName = boost::algorithm::ends_with(name, extensions[i].extension_)
+            ? name : name + extensions[i].extension_;
+        it = catalog.scripts_.find(fileName);
+        if (it == catalog.scripts_.end())
+        {
+            it = probe(catalog, fileName, extensions[i].language_);
+        }
+    }
+    if (it == catalog.scripts_.end())
+    {
+        throw ScriptError("cannot open script " + name);
+    }
+
+    Script & script = it->second;
+    if (script.read_ && hotReload)
+    {
+        const std::time_t modified = modificationTime(script.fileName_);
+        if (modified != script.modified_)
+        {
+            script.modified_ = modified;
+            script.read_ = false;
+        }
+    }
+    if (script.read_ == false)
+    {
+        std::ifstream file(script.fileName_.c_str());
+        if (file.is_open() == false)
+        {
+            throw ScriptError("cannot open script " + name);
+        }
+        script.body_.assign(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+        script.read_ = true;
+    }
+    return script;
+}
+
+void ScriptCatalog::setHotReload(bool reload)
+{
+    hotReload = reload;
+}
+
+void ScriptCatalog::clear()
+{
+    catalogs.clear();
+}
+
+}
+}
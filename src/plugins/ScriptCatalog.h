@@ -0,0 +1,62 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef SCRIPTCATALOG_H_INCLUDED
+#define SCRIPTCATALOG_H_INCLUDED
+
+#include "Interpreter.h"
+#include <ctime>
+#include <string>
+
+
+namespace Vera
+{
+namespace Plugins
+{
+
+// The scripts of the rules and of the transformations of a root directory.
+// The scripts and rules directories of the root are scanned once, on the
+// first lookup, and the text of a script is read once, on its first use:
+// the lookups then don't touch the disk. A name the scan didn't find, such as
+// a path out of the directories, is looked for on the disk and then kept.
+//
+// With the hot reload, for the long running processes, the directories are
+// scanned again when one of them is modified, and a script is read again
+// when it is modified.
+class ScriptCatalog
+{
+public:
+    enum Language { tcl, python, lua };
+
+    struct Script
+    {
+        Interpreter::ScriptName fileName_;
+        Language language_;
+        std::time_t modified_;
+
+        bool read_;
+        std::string body_;
+    };
+
+    // The script with the name, with or without its extension, looked for in
+    // the scripts and the root directories, in Tcl, then in Python and in Lua.
+    // Its text is read if needed.
+    static const Script & find(const Interpreter::DirectoryName & root,
+        Interpreter::ScriptType type, const Interpreter::ScriptName & name);
+
+    // for all the roots, off by default
+    static void setHotReload(bool reload);
+
+    // the roots are scanned again on their next lookup
+    static void clear();
+};
+
+} // namespace Plugins
+
+} // namespace Vera
+
+#endif // SCRIPTCATALOG_H_INCLUDED
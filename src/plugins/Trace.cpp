@@ -0,0 +1,194 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "Trace.h"
+#include "ReportWriters.h"
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <vector>
+
+
+namespace // unnamed
+{
+
+struct Event
+{
+    const char * category_;
+    std::string name_;
+    std::string file_;
+
+    // in microseconds since the trace is enabled
+    boost::int64_t start_;
+    boost::int64_t duration_;
+    int thread_;
+};
+
+typedef std::vector<Event> EventCollection;
+typedef std::map<boost::thread::id, int> ThreadIdMap;
+
+// set before the threads are started
+bool enabled = false;
+boost::posix_time::ptime origin;
+
+// the spans are recorded by the threads of the directory walk too
+boost::mutex mutex;
+EventCollection events;
+ThreadIdMap threads;
+
+// small numbers are easier to read in a trace viewer, with 1 for the main thread
+int getThreadId()
+{
+    const boost::thread::id id = boost::this_thread::get_id();
+    const ThreadIdMap::const_iterator it = threads.find(id);
+    if (it != threads.end())
+    {
+        return it->second;
+    }
+    const int number = static_cast<int>(threads.size()) + 1;
+    threads[id] = number;
+    return number;
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Plugins
+{
+
+void Trace::setEnabled(bool enable)
+{
+    enabled = enable;
+    if (enabled)
+    {
+        origin = boost::posix_time::microsec_clock::universal_time();
+        boost::lock_guard<boost::mutex> lock(mutex);
+        getThreadId();
+    }
+}
+
+bool Trace::isEnabled()
+{
+    return enabled;
+}
+
+Trace::Span::Span(const char * category, const char * name)
+    : category_(category), enabled_(enabled)
+{
+    if (enabled_)
+    {
+        name_ = name;
+        start_ = boost::posix_time::microsec_clock::universal_time();
+    }
+}
+
+Trace::Span::Span(const char * category, const std::string & name)
+    : category_(category), enabled_(enabled)
+{
+    if (enabled_)
+    {
+        name_ = name;
+        start_ = boost::posix_time::microsec_clock::universal_time();
+    }
+}
+
+Trace::Span::Span(const char * category, const char * name, const std::string & file)
+    : category_(category), enabled_(enabled)
+{
+    if (enabled_)
+    {
+        name_ = name;
+        file_ = file;
+        start_ = boost::posix_time::microsec_clock::universal_time();
+    }
+}
+
+Trace::Span::~Span()
+{
+    if (enabled_)
+    {
+        const boost::posix_time::ptime end = boost::posix_time::microsec_clock::universal_time();
+
+        Event event;
+        event.category_ = category_;
+        event.name_.swap(name_);
+        event.file_.swap(file_);
+        event.start_ = (start_ - origin).total_microseconds();
+        event.duration_ = (end - start_).total_microseconds();
+
+        boost::lock_guard<boost::mutex> lock(mutex);
+        event.thread_ = getThreadId();
+        events.push_back(event);
+    }
+}
+
+void Trace::write(std::ostream & os)
+{
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    std::string buffer = "{ \"traceEvents\": [";
+    for (EventCollection::const_iterator it = events.begin(); it != events.end(); ++it)
+    {
+        buffer += it == events.begin() ? "\n" : ",\n";
+        buffer += "  { \"name\": ";
+        ReportWriter::appendJsonString(buffer, it->name_);
+        buffer += ", \"cat\": ";
+        ReportWriter::appendJsonString(buffer, it->category_);
+
+        std::ostringstream ss;
+        ss << ", \"ph\": \"X\", \"ts\": " << it->start_ << ", \"dur\": " << it->duration_
+            << ", \"pid\": 1, \"tid\": " << it->thread_;
+        buffer += ss.str();
+        if (it->file_.empty() == false)
+        {
+            buffer += ", \"args\": { \"file\": ";
+            ReportWriter::appendJsonString(buffer, it->file_);
+            buffer += " }";
+        }
+        buffer += " }";
+
+        if (buffer.size() >= 64 * 1024)
+        {
+            os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    buffer += events.empty() ? "],\n" : "\n],\n";
+    buffer += "  \"displayTimeUnit\": \"ms\" }\n";
+    os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+struct Trace::State
+{
+    State() : enabled_(false) {}
+
+    bool enabled_;
+    boost::posix_time::ptime origin_;
+    EventCollection events_;
+    ThreadIdMap threads_;
+};
+
+boost::shared_ptr<Trace::State> Trace::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void Trace::swapState(State & state)
+{
+    boost::lock_guard<boost::mutex> lock(mutex);
+    std::swap(enabled, state.enabled_);
+    std::swap(origin, state.origin_);
+    events.swap(state.events_);
+    threads.swap(state.threads_);
+}
+
+}
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/shared_ptr.hpp>
+#include <ostream>
+#include <string>
+
+
+namespace Vera
+{
+namespace Plugins
+{
+
+// Records the spans of the run, with the threads they run on, and writes them
+// as Chrome trace events that can be loaded in a trace viewer. Nothing is
+// recorded until it is enabled.
+class Trace
+{
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // a span from the construction to the destruction, in the calling thread
+    class Span
+    {
+    public:
+        Span(const char * category, const char * name);
+        Span(const char * category, const std::string & name);
+        // with the file the span works on
+        Span(const char * category, const char * name, const std::string & file);
+        ~Span();
+
+    private:
+        const char * const category_;
+        const bool enabled_;
+        std::string name_;
+        std::string file_;
+        boost::posix_time::ptime start_;
+    };
+
+    static void write(std::ostream & os);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
+};
+
+} // namespace Plugins
+
+} // namespace Vera
+
+#endif // TRACE_H_INCLUDED
@@ -16,6 +16,7 @@
 #include "../../structures/Tokens.h"
 #include <fstream>
 #include <iterator>
+#include <map>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -84,32 +85,16 @@ namespace Plugins
 
 // Structures::SourceFiles::getAllFileNames() returns a std::set that is not
 // easily wrapped with luabind. It also lack the filtering of the excluded
-// files
-std::vector<std::string> sourceFileNames;
-std::vector<std::string> const& luaGetSourceFileNames()
+// files, that is done once per rule by Exclusions
+Exclusions::FileNameCollection const& luaGetSourceFileNames()
 {
-    if (sourceFileNames.empty())
-    {
-        const Vera::Structures::SourceFiles::FileNameSet & files =
-                Vera::Structures::SourceFiles::getAllFileNames();
-
-        typedef Vera::Structures::SourceFiles::FileNameSet::const_iterator iterator;
-        const iterator end = files.end();
-        for (iterator it = files.begin(); it != end; ++it)
-        {
-            const Vera::Structures::SourceFiles::FileName & name = *it;
-
-            if (Vera::Plugins::Exclusions::isExcluded(name) == false)
-            {
-                sourceFileNames.push_back(name);
-            }
-        }
-    }
-    return sourceFileNames;
+    return Exclusions::getSourceFileNames(Rules::getCurrentRule());
 }
 
 // Structures::Tokens::getTokens does not return a reference, so we must cache
-// the result to be able to use it with return_stl_iterator
+// the result to be able to use it with return_stl_iterator. The cache only
+// lives for the run of a script, as the files may be unloaded between the runs
+// and the ids of the files belong to the session of the run.
 std::map<std::string, Structures::Tokens::TokenSequence> tokens;
 Structures::Tokens::TokenSequence const& getTokens(
     const Structures::SourceFiles::FileName & fileName,
@@ -117,6 +102,7 @@ Structures::Tokens::TokenSequence const& getTokens(
     const Structures::Tokens::FilterSequence & filter)
 {
   // create a key unique for all these parameters
+  const Structures::SourceFiles::FileId fileId = Structures::SourceFiles::getFileId(fileName);
   std::ostringstream keyStream;
   keyStream << fileName;
   keyStream << "$" << fromLine;
@@ -133,13 +119,61 @@ Structures::Tokens::TokenSequence const& getTokens(
   {
     return it->second;
   }
-  tokens[key] = Structures::Tokens::getTokens(fileName, fromLine, fromColumn,
+  tokens[key] = Structures::Tokens::getTokens(fileId, fromLine, fromColumn,
     toLine, toColumn, filter);
   return tokens[key];
 }
 
+// The lines of a file are released when it is unloaded, so getAllLines copies
+// them into a table of the script, and returns an iterator over that table:
+// the copy belongs to the script and is collected with it.
+int nextLine(lua_State* L)
+{
+  const lua_Integer index = lua_tointeger(L, lua_upvalueindex(2)) + 1;
+  lua_pushinteger(L, index);
+  lua_replace(L, lua_upvalueindex(2));
+  lua_rawgeti(L, lua_upvalueindex(1), static_cast<int>(index));
+  return 1;
+}
+
+int getAllLines(lua_State* L)
+{
+  const char * fileName = luaL_checkstring(L, 1);
+  bool failed = false;
+  try
+  {
+    const Structures::SourceLines::LineCollection & fileLines =
+        Structures::SourceLines::getAllLines(std::string(fileName));
+    lua_createtable(L, static_cast<int>(fileLines.size()), 0);
+    for (std::size_t i = 0; i != fileLines.size(); ++i)
+    {
+      lua_pushlstring(L, fileLines[i].data(), fileLines[i].size());
+      lua_rawseti(L, -2, static_cast<int>(i + 1));
+    }
+  }
+  catch (const std::exception & e)
+  {
+    lua_pushstring(L, e.what());
+    failed = true;
+  }
+  // raised out of the try block, so that no destructor is skipped
+  if (failed)
+  {
+    return lua_error(L);
+  }
+  lua_pushinteger(L, 0);
+  lua_pushcclosure(L, &nextLine, 2);
+  return 1;
+}
+
+// the scripts use the file names, the overloads with the file ids are for the engine
+typedef int (*GetLineCountFunction)(const Structures::SourceFiles::FileName &);
+typedef const std::string & (*GetLineFunction)(const Structures::SourceFiles::FileName &, int);
+
 void LuaInterpreter::execute(const std::string & fileName)
 {
+  tokens.clear();
+
   lua_State* L = luaL_newstate();
   luaL_openlibs(L);
   luabind::open(L);
@@ -163,15 +197,15 @@ void LuaInterpreter::execute(const std::string & fileName)
 
       luabind::def("getSourceFileNames", &luaGetSourceFileNames, luabind::return_stl_iterator),
 
-      luabind::def("getLineCount", &Structures::SourceLines::getLineCount),
-
-      luabind::def("getLine", &Structures::SourceLines::getLine),
+      luabind::def("getLineCount",
+          static_cast<GetLineCountFunction>(&Structures::SourceLines::getLineCount)),
 
-      luabind::def("getAllLines", &Structures::SourceLines::getAllLines,
-          luabind::return_stl_iterator)
+      luabind::def("getLine", static_cast<GetLineFunction>(&Structures::SourceLines::getLine))
 
   ];
 
+  lua_register(L, "getAllLines", &getAllLines);
+
   lua_getglobal(L, "debug");
   lua_getfield(L, -1, "traceback");
   lua_replace(L, -2);
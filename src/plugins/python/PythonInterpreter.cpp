@@ -34,27 +34,10 @@ namespace py = boost::python;
 
 // Structures::SourceFiles::getAllFileNames() returns a std::set that is not
 // easily wrapped with boost python. It also lack the filtering of the excluded
-// files
+// files, that is done once per rule by Exclusions
 std::vector<std::string> pyGetSourceFileNames()
 {
-    std::vector<std::string> res;
-
-    const Vera::Structures::SourceFiles::FileNameSet & files =
-            Vera::Structures::SourceFiles::getAllFileNames();
-
-    typedef Vera::Structures::SourceFiles::FileNameSet::const_iterator iterator;
-    const iterator end = files.end();
-    for (iterator it = files.begin(); it != end; ++it)
-    {
-        const Vera::Structures::SourceFiles::FileName & name = *it;
-
-        if (Vera::Plugins::Exclusions::isExcluded(name) == false)
-        {
-            res.push_back(name);
-        }
-    }
-
-    return res;
+    return Exclusions::getSourceFileNames(Rules::getCurrentRule());
 }
 
 // vector_indexing_suite is not doing all the job - we have to do the conversion
@@ -92,6 +75,15 @@ struct py_seq_to_std_vector
   }
 };
 
+// the scripts use the file names, the overloads with the file ids are for the engine
+typedef Structures::Tokens::TokenSequence (*GetTokensFunction)(
+    const Structures::SourceFiles::FileName &, int, int, int, int,
+    const Structures::Tokens::FilterSequence &);
+typedef int (*GetLineCountFunction)(const Structures::SourceFiles::FileName &);
+typedef const std::string & (*GetLineFunction)(const Structures::SourceFiles::FileName &, int);
+typedef const Structures::SourceLines::LineCollection & (*GetAllLinesFunction)(
+    const Structures::SourceFiles::FileName &);
+
 BOOST_PYTHON_MODULE(vera)
 {
   py_seq_to_std_vector<std::string>();
@@ -112,7 +104,7 @@ BOOST_PYTHON_MODULE(vera)
   py::class_<Structures::SourceLines::LineCollection>("StringVector")
           .def(py::vector_indexing_suite<Structures::SourceLines::LineCollection>());
 
-  py::def("getTokens", &Structures::Tokens::getTokens);
+  py::def("getTokens", static_cast<GetTokensFunction>(&Structures::Tokens::getTokens));
 
   py::def("report", &Plugins::Reports::add);
 
@@ -120,13 +112,15 @@ BOOST_PYTHON_MODULE(vera)
 
   py::def("getSourceFileNames", &pyGetSourceFileNames);
 
-  py::def("getLineCount", &Structures::SourceLines::getLineCount);
+  py::def("getLineCount",
+      static_cast<GetLineCountFunction>(&Structures::SourceLines::getLineCount));
 
-  py::def("getLine", &Structures::SourceLines::getLine,
+  py::def("getLine", static_cast<GetLineFunction>(&Structures::SourceLines::getLine),
       py::return_value_policy<py::copy_const_reference>());
 
-  py::def("getAllLines", &Structures::SourceLines::getAllLines,
-      py::return_value_policy<py::reference_existing_object>());
+  // copied, as the lines of a file are released when it is unloaded
+  py::def("getAllLines", static_cast<GetAllLinesFunction>(&Structures::SourceLines::getAllLines),
+      py::return_value_policy<py::copy_const_reference>());
 };
 
 void PythonInterpreter::execute(const std::string & fileName)
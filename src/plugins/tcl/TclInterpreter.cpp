@@ -41,19 +41,14 @@ Tcl::object getSourceFileNames()
 {
     Tcl::object obj;
 
-    const Vera::Structures::SourceFiles::FileNameSet & files =
-            Vera::Structures::SourceFiles::getAllFileNames();
+    const Vera::Plugins::Exclusions::FileNameCollection & files =
+        Vera::Plugins::Exclusions::getSourceFileNames(Vera::Plugins::Rules::getCurrentRule());
 
-    typedef Vera::Structures::SourceFiles::FileNameSet::const_iterator iterator;
+    typedef Vera::Plugins::Exclusions::FileNameCollection::const_iterator iterator;
     const iterator end = files.end();
     for (iterator it = files.begin(); it != end; ++it)
     {
-        const Vera::Structures::SourceFiles::FileName & name = *it;
-
-        if (Vera::Plugins::Exclusions::isExcluded(name) == false)
-        {
-            obj.append(*pInter, Tcl::object(name));
-        }
+        obj.append(*pInter, Tcl::object(*it));
     }
 
     return obj;
@@ -139,19 +134,8 @@ namespace Vera
 namespace Plugins
 {
 
-void TclInterpreter::execute(const std::string & fileName)
+void TclInterpreter::execute(const ScriptName & fileName, const std::string & scriptBody)
 {
-    std::ifstream scriptFile(fileName.c_str());
-    if (scriptFile.is_open() == false)
-    {
-        std::ostringstream ss;
-        ss << "Cannot open script " << fileName;
-        throw ScriptError(ss.str());
-    }
-
-    std::string scriptBody;
-    scriptBody.assign(std::istreambuf_iterator<char>(scriptFile), std::istreambuf_iterator<char>());
-
     Tcl::interpreter inter;
     registerCommands(inter);
     try
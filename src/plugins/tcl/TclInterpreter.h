@@ -24,7 +24,8 @@ public:
     typedef std::string DirectoryName;
     typedef std::string ScriptName;
 
-    static void execute(const ScriptName & name);
+    // the text of the script is given, the name is for the errors
+    static void execute(const ScriptName & name, const std::string & body);
 };
 
 } // namespace Plugins
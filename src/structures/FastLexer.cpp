@@ -0,0 +1,1430 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "FastLexer.h"
+#include "TokenIds.h"
+#include <boost/wave/wave_config.hpp>
+#include <cstring>
+
+
+namespace // unnamed
+{
+
+namespace wave = boost::wave;
+
+typedef Vera::Structures::TokenIds TokenIds;
+
+enum CharFlag
+{
+    SpaceChar = 1,              // [ \t\v\f]
+    IdentifierStartChar = 2,    // [a-zA-Z_$]
+    IdentifierChar = 4,         // [a-zA-Z0-9_$]
+    DigitChar = 8,
+    HexDigitChar = 16,
+    OctalDigitChar = 32,
+    LiteralChar = 64,           // can be used as is in the literals: [\t\v\f\040-\377]
+    InvalidChar = 128,          // the other control characters
+    BinaryDigitChar = 256,
+    RawDelimiterChar = 512      // in R"delimiter(...)delimiter": the basic characters but [ ()\\]
+};
+
+struct CharTable
+{
+    CharTable()
+    {
+        for (int c = 0; c != 256; ++c)
+        {
+            int flags = 0;
+            const bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            const bool digit = c >= '0' && c <= '9';
+            if (c == ' ' || c == '\t' || c == '\v' || c == '\f')
+            {
+                flags |= SpaceChar;
+            }
+            if (letter || c == '_' || c == '$')
+            {
+                flags |= IdentifierStartChar | IdentifierChar;
+            }
+            if (digit)
+            {
+                flags |= IdentifierChar | DigitChar | HexDigitChar;
+            }
+            if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))
+            {
+                flags |= HexDigitChar;
+            }
+            if (c >= '0' && c <= '7')
+            {
+                flags |= OctalDigitChar;
+            }
+            if (c == '0' || c == '1')
+            {
+                flags |= BinaryDigitChar;
+            }
+            if (c > ' ' && c < 127 && c != '(' && c != ')' && c != '\\' && c != '@' &&
+                c != '$' && c != '`')
+            {
+                flags |= RawDelimiterChar;
+            }
+            if (c >= ' ' || c == '\t' || c == '\v' || c == '\f')
+            {
+                flags |= LiteralChar;
+            }
+            else if (c != '\n' && c != '\r')
+            {
+                flags |= InvalidChar;
+            }
+            flags_[c] = static_cast<unsigned short>(flags);
+        }
+    }
+
+    unsigned short flags_[256];
+};
+
+const CharTable charTable;
+
+inline bool is(char c, int flag)
+{
+    return (charTable.flags_[static_cast<unsigned char>(c)] & flag) != 0;
+}
+
+struct Keyword
+{
+    const char * text_;
+    wave::token_id id_;
+    bool msExtension_;
+};
+
+// the keywords of C++ 98 to C++ 23, the alternative tokens and the Microsoft extensions
+const Keyword keywords[] =
+{
+    { "alignas", wave::T_ALIGNAS, false },
+    { "alignof", wave::T_ALIGNOF, false },
+    { "and", wave::T_ANDAND_ALT, false },
+    { "and_eq", wave::T_ANDASSIGN_ALT, false },
+    { "asm", wave::T_ASM, false },
+    { "auto", wave::T_AUTO, false },
+    { "bitand", wave::T_AND_ALT, false },
+    { "bitor", wave::T_OR_ALT, false },
+    { "bool", wave::T_BOOL, false },
+    { "break", wave::T_BREAK, false },
+    { "case", wave::T_CASE, false },
+    { "catch", wave::T_CATCH, false },
+    { "char", wave::T_CHAR, false },
+    { "char8_t", TokenIds::T_CHAR8_T, false },
+    { "char16_t", wave::T_CHAR16_T, false },
+    { "char32_t", wave::T_CHAR32_T, false },
+    { "class", wave::T_CLASS, false },
+    { "co_await", TokenIds::T_CO_AWAIT, false },
+    { "co_return", TokenIds::T_CO_RETURN, false },
+    { "co_yield", TokenIds::T_CO_YIELD, false },
+    { "compl", wave::T_COMPL_ALT, false },
+    { "concept", TokenIds::T_CONCEPT, false },
+    { "const", wave::T_CONST, false },
+    { "const_cast", wave::T_CONSTCAST, false },
+    { "consteval", TokenIds::T_CONSTEVAL, false },
+    { "constexpr", wave::T_CONSTEXPR, false },
+    { "constinit", TokenIds::T_CONSTINIT, false },
+    { "continue", wave::T_CONTINUE, false },
+    { "decltype", wave::T_DECLTYPE, false },
+    { "default", wave::T_DEFAULT, false },
+    { "delete", wave::T_DELETE, false },
+    { "do", wave::T_DO, false },
+    { "double", wave::T_DOUBLE, false },
+    { "dynamic_cast", wave::T_DYNAMICCAST, false },
+    { "else", wave::T_ELSE, false },
+    { "enum", wave::T_ENUM, false },
+    { "explicit", wave::T_EXPLICIT, false },
+    { "export", wave::T_EXPORT, false },
+    { "extern", wave::T_EXTERN, false },
+    { "false", wave::T_FALSE, false },
+    { "float", wave::T_FLOAT, false },
+    { "for", wave::T_FOR, false },
+    { "friend", wave::T_FRIEND, false },
+    { "goto", wave::T_GOTO, false },
+    { "if", wave::T_IF, false },
+    { "inline", wave::T_INLINE, false },
+    { "int", wave::T_INT, false },
+    { "long", wave::T_LONG, false },
+    { "mutable", wave::T_MUTABLE, false },
+    { "namespace", wave::T_NAMESPACE, false },
+    { "new", wave::T_NEW, false },
+    { "noexcept", wave::T_NOEXCEPT, false },
+    { "not", wave::T_NOT_ALT, false },
+    { "not_eq", wave::T_NOTEQUAL_ALT, false },
+    { "nullptr", wave::T_NULLPTR, false },
+    { "operator", wave::T_OPERATOR, false },
+    { "or", wave::T_OROR_ALT, false },
+    { "or_eq", wave::T_ORASSIGN_ALT, false },
+    { "private", wave::T_PRIVATE, false },
+    { "protected", wave::T_PROTECTED, false },
+    { "public", wave::T_PUBLIC, false },
+    { "register", wave::T_REGISTER, false },
+    { "reinterpret_cast", wave::T_REINTERPRETCAST, false },
+    { "requires", TokenIds::T_REQUIRES, false },
+    { "return", wave::T_RETURN, false },
+    { "short", wave::T_SHORT, false },
+    { "signed", wave::T_SIGNED, false },
+    { "sizeof", wave::T_SIZEOF, false },
+    { "static", wave::T_STATIC, false },
+    { "static_assert", wave::T_STATICASSERT, false },
+    { "static_cast", wave::T_STATICCAST, false },
+    { "struct", wave::T_STRUCT, false },
+    { "switch", wave::T_SWITCH, false },
+    { "template", wave::T_TEMPLATE, false },
+    { "this", wave::T_THIS, false },
+    { "thread_local", wave::T_THREADLOCAL, false },
+    { "throw", wave::T_THROW, false },
+    { "true", wave::T_TRUE, false },
+    { "try", wave::T_TRY, false },
+    { "typedef", wave::T_TYPEDEF, false },
+    { "typeid", wave::T_TYPEID, false },
+    { "typename", wave::T_TYPENAME, false },
+    { "union", wave::T_UNION, false },
+    { "unsigned", wave::T_UNSIGNED, false },
+    { "using", wave::T_USING, false },
+    { "virtual", wave::T_VIRTUAL, false },
+    { "void", wave::T_VOID, false },
+    { "volatile", wave::T_VOLATILE, false },
+    { "wchar_t", wave::T_WCHART, false },
+    { "while", wave::T_WHILE, false },
+    { "xor", wave::T_XOR_ALT, false },
+    { "xor_eq", wave::T_XORASSIGN_ALT, false },
+    { "__int8", wave::T_MSEXT_INT8, true },
+    { "__int16", wave::T_MSEXT_INT16, true },
+    { "__int32", wave::T_MSEXT_INT32, true },
+    { "__int64", wave::T_MSEXT_INT64, true },
+    { "_based", wave::T_MSEXT_BASED, true },
+    { "__based", wave::T_MSEXT_BASED, true },
+    { "_declspec", wave::T_MSEXT_DECLSPEC, true },
+    { "__declspec", wave::T_MSEXT_DECLSPEC, true },
+    { "_cdecl", wave::T_MSEXT_CDECL, true },
+    { "__cdecl", wave::T_MSEXT_CDECL, true },
+    { "_fastcall", wave::T_MSEXT_FASTCALL, true },
+    { "__fastcall", wave::T_MSEXT_FASTCALL, true },
+    { "_stdcall", wave::T_MSEXT_STDCALL, true },
+    { "__stdcall", wave::T_MSEXT_STDCALL, true },
+    { "__try", wave::T_MSEXT_TRY, true },
+    { "__except", wave::T_MSEXT_EXCEPT, true },
+    { "__finally", wave::T_MSEXT_FINALLY, true },
+    { "__leave", wave::T_MSEXT_LEAVE, true },
+    { "_inline", wave::T_MSEXT_INLINE, true },
+    { "__inline", wave::T_MSEXT_INLINE, true },
+    { "_asm", wave::T_MSEXT_ASM, true },
+    { "__asm", wave::T_MSEXT_ASM, true }
+};
+
+const int keywordCount = sizeof(keywords) / sizeof(keywords[0]);
+
+// hash table of the keywords, with the collisions chained
+class KeywordTable
+{
+public:
+    KeywordTable()
+    {
+        for (int i = 0; i != bucketCount; ++i)
+        {
+            buckets_[i] = -1;
+        }
+        for (int i = 0; i != keywordCount; ++i)
+        {
+            const std::size_t length = std::strlen(keywords[i].text_);
+            int & bucket = buckets_[hash(keywords[i].text_, length)];
+            next_[i] = bucket;
+            bucket = i;
+        }
+    }
+
+    wave::token_id find(const char * text, std::size_t length, bool msExtensions) const
+    {
+        if (length >= 2 && length <= maxLength)
+        {
+            for (int i = buckets_[hash(text, length)]; i >= 0; i = next_[i])
+            {
+                const Keyword & keyword = keywords[i];
+                if (std::strncmp(keyword.text_, text, length) == 0 &&
+                    keyword.text_[length] == '\0')
+                {
+                    if (keyword.msExtension_ && msExtensions == false)
+                    {
+                        break;
+                    }
+                    return keyword.id_;
+                }
+            }
+        }
+        return wave::T_IDENTIFIER;
+    }
+
+private:
+    enum { bucketCount = 256, maxLength = 16 };
+
+    static int hash(const char * text, std::size_t length)
+    {
+        const unsigned int first = static_cast<unsigned char>(text[0]);
+        const unsigned int middle = static_cast<unsigned char>(text[length / 2]);
+        const unsigned int last = static_cast<unsigned char>(text[length - 1]);
+        return static_cast<int>((length * 61 + first * 7 + middle * 3 + last) % bucketCount);
+    }
+
+    int buckets_[bucketCount];
+    int next_[keywordCount];
+};
+
+const KeywordTable keywordTable;
+
+struct Directive
+{
+    const char * text_;
+    std::size_t length_;
+    wave::token_id id_;
+};
+
+const Directive directives[] =
+{
+    { "define", 6, wave::T_PP_DEFINE },
+    { "elif", 4, wave::T_PP_ELIF },
+    { "elifdef", 7, TokenIds::T_PP_ELIFDEF },
+    { "elifndef", 8, TokenIds::T_PP_ELIFNDEF },
+    { "else", 4, wave::T_PP_ELSE },
+    { "endif", 5, wave::T_PP_ENDIF },
+    { "endregion", 9, wave::T_MSEXT_PP_ENDREGION },
+    { "error", 5, wave::T_PP_ERROR },
+    { "if", 2, wave::T_PP_IF },
+    { "ifdef", 5, wave::T_PP_IFDEF },
+    { "ifndef", 6, wave::T_PP_IFNDEF },
+    { "include", 7, wave::T_PP_INCLUDE },
+    { "include_next", 12, wave::T_PP_INCLUDE_NEXT },
+    { "line", 4, wave::T_PP_LINE },
+    { "pragma", 6, wave::T_PP_PRAGMA },
+    { "region", 6, wave::T_MSEXT_PP_REGION },
+    { "undef", 5, wave::T_PP_UNDEF },
+    { "warning", 7, wave::T_PP_WARNING }
+};
+
+const int directiveCount = sizeof(directives) / sizeof(directives[0]);
+
+bool isTrigraphBackslash(const char * p)
+{
+    return p[0] == '?' && p[1] == '?' && p[2] == '/';
+}
+
+int backslashLength(const char * p)
+{
+    if (*p == '\\')
+    {
+        return 1;
+    }
+    return isTrigraphBackslash(p) ? 3 : 0;
+}
+
+const char * hexDigitsEnd(const char * p, int count)
+{
+    for (int i = 0; i != count; ++i)
+    {
+        if (is(p[i], HexDigitChar) == false)
+        {
+            return 0;
+        }
+    }
+    return p + count;
+}
+
+// end of the delimited escape sequence of C++ 23 starting with the brace at p,
+// as in \x{1F600}, or 0
+const char * delimitedEscapeEnd(const char * p, int flag)
+{
+    const char * q = p + 1;
+    while (is(*q, flag))
+    {
+        ++q;
+    }
+    return (*q == '}' && q != p + 1) ? q + 1 : 0;
+}
+
+// end of the named universal character of C++ 23 starting with the brace at p,
+// as in \N{LATIN SMALL LETTER A}, or 0
+const char * characterNameEnd(const char * p)
+{
+    const char * q = p + 1;
+    while ((*q >= 'A' && *q <= 'Z') || is(*q, DigitChar) || *q == ' ' || *q == '-')
+    {
+        ++q;
+    }
+    return (*p == '{' && *q == '}' && q != p + 1) ? q + 1 : 0;
+}
+
+// end of the universal character name following a backslash, or 0
+const char * universalCharEnd(const char * p)
+{
+    switch (*p)
+    {
+    case 'u':
+        return p[1] == '{' ? delimitedEscapeEnd(p + 1, HexDigitChar) : hexDigitsEnd(p + 1, 4);
+    case 'U':
+        return hexDigitsEnd(p + 1, 8);
+    case 'N':
+        return characterNameEnd(p + 1);
+    default:
+        return 0;
+    }
+}
+
+// length of the universal character name at p, or 0
+int universalCharLength(const char * p)
+{
+    const int backslash = backslashLength(p);
+    if (backslash != 0)
+    {
+        const char * const end = universalCharEnd(p + backslash);
+        if (end != 0)
+        {
+            return static_cast<int>(end - p);
+        }
+    }
+    return 0;
+}
+
+const char * identifierEnd(const char * p)
+{
+    for (;;)
+    {
+        if (is(*p, IdentifierChar))
+        {
+            ++p;
+        }
+        else
+        {
+            const int length = universalCharLength(p);
+            if (length == 0)
+            {
+                return p;
+            }
+            p += length;
+        }
+    }
+}
+
+// end of the escape sequence following a backslash, or 0 if it is invalid
+const char * escapeEnd(const char * p)
+{
+    switch (*p)
+    {
+    case 'a': case 'b': case 'f': case 'n': case 'r': case 't': case 'v':
+    case '?': case '\'': case '"': case '\\':
+        return p + 1;
+    case 'x':
+        if (p[1] == '{')
+        {
+            return delimitedEscapeEnd(p + 1, HexDigitChar);
+        }
+        if (is(p[1], HexDigitChar) == false)
+        {
+            return 0;
+        }
+        p += 2;
+        while (is(*p, HexDigitChar))
+        {
+            ++p;
+        }
+        return p;
+    case 'o':
+        return p[1] == '{' ? delimitedEscapeEnd(p + 1, OctalDigitChar) : 0;
+    case 'u':
+    case 'U':
+    case 'N':
+        return universalCharEnd(p);
+    default:
+        if (is(*p, OctalDigitChar) == false)
+        {
+            return 0;
+        }
+        ++p;
+        for (int i = 0; i != 2 && is(*p, OctalDigitChar); ++i)
+        {
+            ++p;
+        }
+        return p;
+    }
+}
+
+// The trigraph ??/ is a backslash, but also three characters of the literal:
+// all the ways to read the literal are followed, and the longest one is kept.
+const char * ambiguousLiteralEnd(const char * body, char quote)
+{
+    const char * lineEnd = body;
+    while (*lineEnd != '\n' && *lineEnd != '\r' && *lineEnd != '\0')
+    {
+        ++lineEnd;
+    }
+    const std::size_t length = static_cast<std::size_t>(lineEnd - body);
+
+    std::vector<bool> reached(length + 1, false);
+    reached[0] = true;
+    const char * end = 0;
+    for (std::size_t i = 0; i != length; ++i)
+    {
+        if (reached[i] == false)
+        {
+            continue;
+        }
+        const char * p = body + i;
+        const char * escape = 0;
+        if (*p == quote)
+        {
+            if (quote != '\'' || i != 0)
+            {
+                end = p + 1;
+            }
+            continue;
+        }
+        else if (*p == '\\')
+        {
+            escape = escapeEnd(p + 1);
+        }
+        else if (is(*p, LiteralChar))
+        {
+            reached[i + 1] = true;
+            if (isTrigraphBackslash(p))
+            {
+                escape = escapeEnd(p + 3);
+            }
+        }
+        if (escape != 0)
+        {
+            reached[escape - body] = true;
+        }
+    }
+    return end;
+}
+
+// end of the character or string literal starting with the quote at p,
+// or 0 if there is none
+const char * literalEnd(const char * p)
+{
+    const char quote = *p;
+    const char * const body = p + 1;
+    for (p = body; ; )
+    {
+        if (*p == quote)
+        {
+            return (quote == '\'' && p == body) ? 0 : p + 1;
+        }
+        else if (*p == '\\')
+        {
+            p = escapeEnd(p + 1);
+            if (p == 0)
+            {
+                return 0;
+            }
+        }
+        else if (isTrigraphBackslash(p))
+        {
+            return ambiguousLiteralEnd(body, quote);
+        }
+        else if (is(*p, LiteralChar))
+        {
+            ++p;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+}
+
+// The user-defined suffix of C++ 11 following a string or a character literal.
+// Only the suffixes starting with an underscore and the ones of the standard
+// library are taken, as "%d"PRId64 is a string followed by a macro in C.
+const char * udSuffixEnd(const char * p)
+{
+    const char * const end = identifierEnd(p);
+    if (*p == '_' || (end - p == 1 && p[0] == 's') ||
+        (end - p == 2 && p[0] == 's' && p[1] == 'v'))
+    {
+        return end;
+    }
+    return p;
+}
+
+// end of the header name of the include directive, or 0
+const char * headerEnd(const char * p, char close)
+{
+    const char * const body = p + 1;
+    for (p = body; *p != close && is(*p, LiteralChar); ++p)
+    {
+    }
+    return (*p == close && p != body) ? p + 1 : 0;
+}
+
+// the white spaces allowed in the preprocessor directives, before the
+// directive name and the header name: blanks and C comments
+const char * ppSpaceEnd(const char * p)
+{
+    for (;;)
+    {
+        if (is(*p, SpaceChar))
+        {
+            ++p;
+        }
+        else if (p[0] == '/' && p[1] == '*')
+        {
+            const char * q = p + 2;
+            while (q[0] != '*' || q[1] != '/')
+            {
+                if (is(*q, LiteralChar) == false && *q != '\n' && *q != '\r')
+                {
+                    return p;
+                }
+                ++q;
+            }
+            p = q + 2;
+        }
+        else
+        {
+            return p;
+        }
+    }
+}
+
+// the digits can be separated by quotes since C++ 14, as in 1'000'000
+const char * digitsEnd(const char * p, int flag)
+{
+    while (is(*p, flag) || (*p == '\'' && is(p[-1], flag) && is(p[1], flag)))
+    {
+        ++p;
+    }
+    return p;
+}
+
+// e for the decimal literals, p for the hexadecimal ones
+const char * exponentEnd(const char * p, char exponent)
+{
+    if (*p == exponent || *p == exponent - 'a' + 'A')
+    {
+        const char * q = p + 1;
+        if (*q == '+' || *q == '-')
+        {
+            ++q;
+        }
+        if (is(*q, DigitChar))
+        {
+            return digitsEnd(q, DigitChar);
+        }
+    }
+    return p;
+}
+
+bool isU(char c)
+{
+    return c == 'u' || c == 'U';
+}
+
+bool isL(char c)
+{
+    return c == 'l' || c == 'L';
+}
+
+const char * integerSuffixEnd(const char * p, bool msExtensions, wave::token_id & id)
+{
+    id = wave::T_LONGINTLIT;
+    const bool longLong = (p[0] == 'l' && p[1] == 'l') || (p[0] == 'L' && p[1] == 'L');
+    if (isU(p[0]) && ((p[1] == 'l' && p[2] == 'l') || (p[1] == 'L' && p[2] == 'L')))
+    {
+        return p + 3;
+    }
+    if (longLong)
+    {
+        return isU(p[2]) ? p + 3 : p + 2;
+    }
+    if (msExtensions)
+    {
+        if (p[0] == 'i' && p[1] == '6' && p[2] == '4')
+        {
+            return p + 3;
+        }
+        if (p[0] == 'u' && p[1] == 'i' && p[2] == '6' && p[3] == '4')
+        {
+            return p + 4;
+        }
+    }
+
+    id = wave::T_INTLIT;
+    if (isU(p[0]))
+    {
+        return isL(p[1]) ? p + 2 : p + 1;
+    }
+    if (isL(p[0]))
+    {
+        return isU(p[1]) ? p + 2 : p + 1;
+    }
+    return p;
+}
+
+const char * floatSuffixEnd(const char * p)
+{
+    if (*p == 'f' || *p == 'F')
+    {
+        return isL(p[1]) ? p + 2 : p + 1;
+    }
+    else if (isL(*p))
+    {
+        return (p[1] == 'f' || p[1] == 'F') ? p + 2 : p + 1;
+    }
+    return p;
+}
+
+// p is after 0x
+const char * hexadecimalEnd(const char * p, bool msExtensions, wave::token_id & id)
+{
+    const char * q = digitsEnd(p, HexDigitChar);
+    if (*q == '.' || *q == 'p' || *q == 'P')
+    {
+        // the hexadecimal floating literals of C++ 17, as in 0x1.8p3
+        const char * fraction = q;
+        if (*fraction == '.')
+        {
+            fraction = digitsEnd(fraction + 1, HexDigitChar);
+        }
+        const char * const exponent = exponentEnd(fraction, 'p');
+        if (exponent != fraction && (q != p || fraction - q > 1))
+        {
+            id = wave::T_FLOATLIT;
+            return floatSuffixEnd(exponent);
+        }
+    }
+    return q == p ? 0 : integerSuffixEnd(q, msExtensions, id);
+}
+
+const char * decimalEnd(const char * p, bool msExtensions, wave::token_id & id)
+{
+    // the floating literals are tried first, as the longest match
+    const char * q = digitsEnd(p, DigitChar);
+    bool floating = false;
+    if (*q == '.')
+    {
+        q = digitsEnd(q + 1, DigitChar);
+        floating = true;
+    }
+    const char * const exponent = exponentEnd(q, 'e');
+    if (exponent != q)
+    {
+        q = exponent;
+        floating = true;
+    }
+    if (floating)
+    {
+        id = wave::T_FLOATLIT;
+        return floatSuffixEnd(q);
+    }
+    return integerSuffixEnd(q, msExtensions, id);
+}
+
+// p is at a digit, or at a dot followed by a digit
+const char * numberEnd(const char * p, bool msExtensions, wave::token_id & id)
+{
+    const char * end = 0;
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        end = hexadecimalEnd(p + 2, msExtensions, id);
+    }
+    else if (p[0] == '0' && (p[1] == 'b' || p[1] == 'B') && is(p[2], BinaryDigitChar))
+    {
+        // the binary literals of C++ 14
+        end = integerSuffixEnd(digitsEnd(p + 2, BinaryDigitChar), msExtensions, id);
+    }
+    if (end == 0)
+    {
+        end = decimalEnd(p, msExtensions, id);
+    }
+
+    // as a preprocessing number, the literal goes on with the letters and the digits:
+    // they are the user-defined suffix of C++ 11, or the suffixes of the later
+    // standards, as in 10ms, 1.5_km, 1uz or 1.0f16
+    return identifierEnd(end);
+}
+
+const char * oneOrTwo(const char * p, char second,
+    wave::token_id one, wave::token_id two, wave::token_id & id)
+{
+    if (p[1] == second)
+    {
+        id = two;
+        return p + 2;
+    }
+    id = one;
+    return p + 1;
+}
+
+// true if Wave gives the spelling of the token kind rather than the text
+// of the source as the value of the token
+bool usesTokenSpelling(wave::token_id id)
+{
+    if (TokenIds::isExtended(id) || id == wave::T_THREADLOCAL)
+    {
+        // not known to Wave, or misspelled as "threadlocal"
+        return false;
+    }
+
+    switch (id)
+    {
+    case wave::T_IDENTIFIER:
+    case wave::T_STRINGLIT:
+    case wave::T_CHARLIT:
+    case wave::T_RAWSTRINGLIT:
+    case wave::T_PP_HHEADER:
+    case wave::T_PP_QHEADER:
+    case wave::T_PP_INCLUDE:
+    case wave::T_LONGINTLIT:
+    case wave::T_OCTALINT:
+    case wave::T_DECIMALINT:
+    case wave::T_HEXAINT:
+    case wave::T_INTLIT:
+    case wave::T_FLOATLIT:
+    case wave::T_FIXEDPOINTLIT:
+    case wave::T_CCOMMENT:
+    case wave::T_CPPCOMMENT:
+    case wave::T_SPACE:
+    case wave::T_SPACE2:
+    case wave::T_ANY:
+    case wave::T_PP_NUMBER:
+    case wave::T_EOF:
+    case wave::T_OR_TRIGRAPH:
+    case wave::T_XOR_TRIGRAPH:
+    case wave::T_LEFTBRACE_TRIGRAPH:
+    case wave::T_RIGHTBRACE_TRIGRAPH:
+    case wave::T_LEFTBRACKET_TRIGRAPH:
+    case wave::T_RIGHTBRACKET_TRIGRAPH:
+    case wave::T_COMPL_TRIGRAPH:
+    case wave::T_POUND_TRIGRAPH:
+    case wave::T_ANY_TRIGRAPH:
+        return false;
+    default:
+        return CATEGORY_FROM_TOKEN(id) == EXTCATEGORY_FROM_TOKEN(id) &&
+            IS_CATEGORY(id, wave::UnknownTokenType) == false;
+    }
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Structures
+{
+
+FastLexer::FastLexer(const std::string & src, bool msExtensions)
+    : msExtensions_(msExtensions), nextSplice_(0), countedSplice_(0), removed_(0),
+    line_(1), done_(false)
+{
+    // the line continuations are removed before the lexing, as Wave does,
+    // and their offsets are kept for the line numbers and the offsets in
+    // the original source
+    std::string::size_type copied = 0;
+    std::string::size_type pos = src.find_first_of("\\/");
+    for ( ; pos != std::string::npos; pos = src.find_first_of("\\/", pos + 1))
+    {
+        std::string::size_type begin = pos;
+        if (src[pos] == '/')
+        {
+            if (pos < 2 || src[pos - 1] != '?' || src[pos - 2] != '?')
+            {
+                continue;
+            }
+            begin = pos - 2;
+        }
+        std::string::size_type end = pos + 1;
+        if (end != src.size() && src[end] == '\r')
+        {
+            ++end;
+            if (end != src.size() && src[end] == '\n')
+            {
+                ++end;
+            }
+        }
+        else if (end != src.size() && src[end] == '\n')
+        {
+            ++end;
+        }
+        else
+        {
+            continue;
+        }
+
+        spliced_.append(src, copied, begin - copied);
+        Splice splice;
+        splice.at_ = static_cast<int>(spliced_.size());
+        splice.length_ = static_cast<int>(end - begin);
+        splices_.push_back(splice);
+        copied = end;
+        pos = end - 1;
+    }
+
+    if (splices_.empty())
+    {
+        buffer_ = src.c_str();
+        end_ = buffer_ + src.size();
+    }
+    else
+    {
+        spliced_.append(src, copied, std::string::npos);
+        buffer_ = spliced_.c_str();
+        end_ = buffer_ + spliced_.size();
+    }
+    current_ = buffer_;
+    lineBegin_ = buffer_;
+}
+
+bool FastLexer::next(Token & token)
+{
+    if (done_)
+    {
+        return false;
+    }
+
+    const char * p = current_;
+    const int begin = static_cast<int>(p - buffer_);
+    while (nextSplice_ != splices_.size() && splices_[nextSplice_].at_ <= begin)
+    {
+        removed_ += splices_[nextSplice_].length_;
+        ++nextSplice_;
+    }
+    token.line_ = line_;
+    token.column_ = static_cast<int>(p - lineBegin_);
+    token.begin_ = begin;
+    token.offset_ = begin + removed_;
+
+    bool canonical = true;
+    wave::token_id id = wave::T_IDENTIFIER;
+    const char * end = p + 1;
+
+    if (p == end_)
+    {
+        id = wave::T_EOF;
+        end = p;
+        canonical = false;
+        done_ = true;
+    }
+    else if (is(*p, IdentifierStartChar))
+    {
+        end = scanPrefixedLiteral(p, id);
+        if (end == 0)
+        {
+            end = identifierEnd(p + 1);
+            id = keywordTable.find(p, static_cast<std::size_t>(end - p), msExtensions_);
+        }
+    }
+    else if (is(*p, DigitChar) || (*p == '.' && is(p[1], DigitChar)))
+    {
+        end = numberEnd(p, msExtensions_, id);
+    }
+    else
+    {
+        end = scanPunctuation(p, id, canonical);
+    }
+
+    current_ = end;
+    token.id_ = id;
+    token.end_ = static_cast<int>(end - buffer_);
+
+    // the line continuations are counted as new lines by Wave at the end of
+    // the tokens, but they do not change the columns
+    while (countedSplice_ != splices_.size() && splices_[countedSplice_].at_ <= token.end_)
+    {
+        ++line_;
+        ++countedSplice_;
+    }
+    token.inSource_ = canonical &&
+        (nextSplice_ == splices_.size() || splices_[nextSplice_].at_ >= token.end_);
+    return true;
+}
+
+std::string FastLexer::getValue(const Token & token) const
+{
+    if (token.id_ == wave::T_EOF)
+    {
+        return std::string();
+    }
+    else if (usesTokenSpelling(token.id_))
+    {
+        return wave::get_token_value(token.id_);
+    }
+    else
+    {
+        return std::string(buffer_ + token.begin_, buffer_ + token.end_);
+    }
+}
+
+wave::token_id FastLexer::getKeywordId(const std::string & word, bool msExtensions)
+{
+    return keywordTable.find(word.c_str(), word.size(), msExtensions);
+}
+
+const char * FastLexer::scanPunctuation(const char * p, wave::token_id & id, bool & canonical)
+{
+    switch (*p)
+    {
+    case ' ': case '\t': case '\v': case '\f':
+        id = wave::T_SPACE;
+        do
+        {
+            ++p;
+        }
+        while (is(*p, SpaceChar));
+        return p;
+    case '\n':
+        id = wave::T_NEWLINE;
+        return newLine(p + 1);
+    case '\r':
+        id = wave::T_NEWLINE;
+        canonical = false;
+        return newLine(p[1] == '\n' ? p + 2 : p + 1);
+    case '/':
+        if (p[1] == '*')
+        {
+            id = wave::T_CCOMMENT;
+            return scanCComment(p + 2);
+        }
+        if (p[1] == '/')
+        {
+            id = wave::T_CPPCOMMENT;
+            return scanCppComment(p + 2);
+        }
+        return oneOrTwo(p, '=', wave::T_DIVIDE, wave::T_DIVIDEASSIGN, id);
+    case '\'':
+    case '"':
+        {
+            const char * const end = literalEnd(p);
+            if (end != 0)
+            {
+                id = *p == '\'' ? wave::T_CHARLIT : wave::T_STRINGLIT;
+                return udSuffixEnd(end);
+            }
+        }
+        break;
+    case '\\':
+        if (universalCharLength(p) != 0)
+        {
+            id = wave::T_IDENTIFIER;
+            return identifierEnd(p);
+        }
+        break;
+    case '#':
+        if (p[1] == '#')
+        {
+            id = wave::T_POUND_POUND;
+            return p + 2;
+        }
+        if (p[1] == '?' && p[2] == '?' && p[3] == '=')
+        {
+            id = wave::T_POUND_POUND_TRIGRAPH;
+            return p + 4;
+        }
+        return scanPound(p, 1, wave::T_POUND, id, canonical);
+    case '%':
+        if (p[1] == ':')
+        {
+            if (p[2] == '%' && p[3] == ':')
+            {
+                id = wave::T_POUND_POUND_ALT;
+                return p + 4;
+            }
+            return scanPound(p, 2, wave::T_POUND_ALT, id, canonical);
+        }
+        if (p[1] == '>')
+        {
+            id = wave::T_RIGHTBRACE_ALT;
+            return p + 2;
+        }
+        return oneOrTwo(p, '=', wave::T_PERCENT, wave::T_PERCENTASSIGN, id);
+    case '?':
+        if (p[1] == '?')
+        {
+            return scanTrigraph(p, id, canonical);
+        }
+        id = wave::T_QUESTION_MARK;
+        return p + 1;
+    case '.':
+        if (p[1] == '.' && p[2] == '.')
+        {
+            id = wave::T_ELLIPSIS;
+            return p + 3;
+        }
+        return oneOrTwo(p, '*', wave::T_DOT, wave::T_DOTSTAR, id);
+    case ':':
+        if (p[1] == '>')
+        {
+            id = wave::T_RIGHTBRACKET_ALT;
+            return p + 2;
+        }
+        return oneOrTwo(p, ':', wave::T_COLON, wave::T_COLON_COLON, id);
+    case '<':
+        if (p[1] == '<')
+        {
+            id = p[2] == '=' ? wave::T_SHIFTLEFTASSIGN : wave::T_SHIFTLEFT;
+            return p[2] == '=' ? p + 3 : p + 2;
+        }
+        if (p[1] == ':')
+        {
+            // as std::vector<::std::string> since C++ 11
+            const bool less = p[2] == ':' && p[3] != ':' && p[3] != '>';
+            id = less ? wave::T_LESS : wave::T_LEFTBRACKET_ALT;
+            return less ? p + 1 : p + 2;
+        }
+        if (p[1] == '%')
+        {
+            id = wave::T_LEFTBRACE_ALT;
+            return p + 2;
+        }
+        if (p[1] == '=' && p[2] == '>')
+        {
+            id = TokenIds::T_SPACESHIP;
+            return p + 3;
+        }
+        return oneOrTwo(p, '=', wave::T_LESS, wave::T_LESSEQUAL, id);
+    case '>':
+        if (p[1] == '>')
+        {
+            id = p[2] == '=' ? wave::T_SHIFTRIGHTASSIGN : wave::T_SHIFTRIGHT;
+            return p[2] == '=' ? p + 3 : p + 2;
+        }
+        return oneOrTwo(p, '=', wave::T_GREATER, wave::T_GREATEREQUAL, id);
+    case '-':
+        if (p[1] == '>')
+        {
+            id = p[2] == '*' ? wave::T_ARROWSTAR : wave::T_ARROW;
+            return p[2] == '*' ? p + 3 : p + 2;
+        }
+        if (p[1] == '-')
+        {
+            id = wave::T_MINUSMINUS;
+            return p + 2;
+        }
+        return oneOrTwo(p, '=', wave::T_MINUS, wave::T_MINUSASSIGN, id);
+    case '+':
+        if (p[1] == '+')
+        {
+            id = wave::T_PLUSPLUS;
+            return p + 2;
+        }
+        return oneOrTwo(p, '=', wave::T_PLUS, wave::T_PLUSASSIGN, id);
+    case '&':
+        if (p[1] == '&')
+        {
+            id = wave::T_ANDAND;
+            return p + 2;
+        }
+        return oneOrTwo(p, '=', wave::T_AND, wave::T_ANDASSIGN, id);
+    case '|':
+        if (p[1] == '|')
+        {
+            id = wave::T_OROR;
+            return p + 2;
+        }
+        if (p[1] == '?' && p[2] == '?' && p[3] == '!')
+        {
+            id = wave::T_OROR_TRIGRAPH;
+            return p + 4;
+        }
+        return oneOrTwo(p, '=', wave::T_OR, wave::T_ORASSIGN, id);
+    case '^':
+        return oneOrTwo(p, '=', wave::T_XOR, wave::T_XORASSIGN, id);
+    case '*':
+        return oneOrTwo(p, '=', wave::T_STAR, wave::T_STARASSIGN, id);
+    case '=':
+        return oneOrTwo(p, '=', wave::T_ASSIGN, wave::T_EQUAL, id);
+    case '!':
+        return oneOrTwo(p, '=', wave::T_NOT, wave::T_NOTEQUAL, id);
+    case '~':
+        id = wave::T_COMPL;
+        return p + 1;
+    case ',':
+        id = wave::T_COMMA;
+        return p + 1;
+    case ';':
+        id = wave::T_SEMICOLON;
+        return p + 1;
+    case '(':
+        id = wave::T_LEFTPAREN;
+        return p + 1;
+    case ')':
+        id = wave::T_RIGHTPAREN;
+        return p + 1;
+    case '[':
+        id = wave::T_LEFTBRACKET;
+        return p + 1;
+    case ']':
+        id = wave::T_RIGHTBRACKET;
+        return p + 1;
+    case '{':
+        id = wave::T_LEFTBRACE;
+        return p + 1;
+    case '}':
+        id = wave::T_RIGHTBRACE;
+        return p + 1;
+    default:
+        break;
+    }
+
+    if (is(*p, InvalidChar))
+    {
+        // Wave gives up here
+        id = wave::T_ANY;
+    }
+    else
+    {
+        id = TOKEN_FROM_ID(static_cast<unsigned char>(*p), wave::UnknownTokenType);
+    }
+    return p + 1;
+}
+
+const char * FastLexer::scanPrefixedLiteral(const char * p, wave::token_id & id)
+{
+    const char * quote = p;
+    if (p[0] == 'u' && p[1] == '8')
+    {
+        quote = p + 2;
+    }
+    else if (*p == 'L' || *p == 'u' || *p == 'U')
+    {
+        quote = p + 1;
+    }
+
+    const char * end = 0;
+    if (quote[0] == 'R' && quote[1] == '"')
+    {
+        id = wave::T_RAWSTRINGLIT;
+        end = scanRawString(quote + 1);
+    }
+    else if (quote != p && (*quote == '\'' || *quote == '"'))
+    {
+        id = *quote == '\'' ? wave::T_CHARLIT : wave::T_STRINGLIT;
+        end = literalEnd(quote);
+    }
+    return end == 0 ? 0 : udSuffixEnd(end);
+}
+
+const char * FastLexer::scanRawString(const char * p)
+{
+    const std::size_t maxDelimiterLength = 16;
+
+    const char * const delimiter = p + 1;
+    const char * open = delimiter;
+    while (is(*open, RawDelimiterChar) && *open != '"')
+    {
+        ++open;
+    }
+    const std::size_t length = static_cast<std::size_t>(open - delimiter);
+    if (*open != '(' || length > maxDelimiterLength)
+    {
+        return 0;
+    }
+
+    for (const char * q = open + 1; q != end_; ++q)
+    {
+        if (*q == ')' && std::strncmp(q + 1, delimiter, length) == 0 && q[length + 1] == '"')
+        {
+            return q + length + 2;
+        }
+        else if (*q == '\n')
+        {
+            newLine(q + 1);
+        }
+        else if (*q == '\r' && q[1] != '\n')
+        {
+            newLine(q + 1);
+        }
+    }
+
+    // unterminated literal
+    return end_;
+}
+
+const char * FastLexer::scanTrigraph(const char * p, wave::token_id & id, bool & canonical)
+{
+    switch (p[2])
+    {
+    case '=':
+        if (p[3] == '?' && p[4] == '?' && p[5] == '=')
+        {
+            id = wave::T_POUND_POUND_TRIGRAPH;
+            return p + 6;
+        }
+        if (p[3] == '#')
+        {
+            id = wave::T_POUND_POUND_TRIGRAPH;
+            return p + 4;
+        }
+        return scanPound(p, 3, wave::T_POUND_TRIGRAPH, id, canonical);
+    case '/':
+        if (universalCharLength(p) != 0)
+        {
+            id = wave::T_IDENTIFIER;
+            return identifierEnd(p);
+        }
+        id = wave::T_ANY_TRIGRAPH;
+        return p + 3;
+    case '\'':
+        if (p[3] == '=')
+        {
+            id = wave::T_XORASSIGN_TRIGRAPH;
+            return p + 4;
+        }
+        id = wave::T_XOR_TRIGRAPH;
+        return p + 3;
+    case '!':
+        if ((p[3] == '?' && p[4] == '?' && p[5] == '!'))
+        {
+            id = wave::T_OROR_TRIGRAPH;
+            return p + 6;
+        }
+        if (p[3] == '|')
+        {
+            id = wave::T_OROR_TRIGRAPH;
+            return p + 4;
+        }
+        if (p[3] == '=')
+        {
+            id = wave::T_ORASSIGN_TRIGRAPH;
+            return p + 4;
+        }
+        id = wave::T_OR_TRIGRAPH;
+        return p + 3;
+    case '(':
+        id = wave::T_LEFTBRACKET_TRIGRAPH;
+        return p + 3;
+    case ')':
+        id = wave::T_RIGHTBRACKET_TRIGRAPH;
+        return p + 3;
+    case '<':
+        id = wave::T_LEFTBRACE_TRIGRAPH;
+        return p + 3;
+    case '>':
+        id = wave::T_RIGHTBRACE_TRIGRAPH;
+        return p + 3;
+    case '-':
+        id = wave::T_COMPL_TRIGRAPH;
+        return p + 3;
+    default:
+        id = wave::T_QUESTION_MARK;
+        return p + 1;
+    }
+}
+
+const char * FastLexer::scanPound(const char * p, int poundLength, wave::token_id poundId,
+    wave::token_id & id, bool & canonical)
+{
+    // the longest directive name at the beginning of the word, as "#iffy"
+    // is "#if" followed by "fy" for Wave
+    const char * const name = ppSpaceEnd(p + poundLength);
+    const char * word = name;
+    while ((*word >= 'a' && *word <= 'z') || *word == '_')
+    {
+        ++word;
+    }
+    const std::size_t wordLength = static_cast<std::size_t>(word - name);
+    const Directive * directive = 0;
+    for (int i = 0; i != directiveCount; ++i)
+    {
+        const Directive & d = directives[i];
+        if (d.length_ <= wordLength && std::strncmp(d.text_, name, d.length_) == 0 &&
+            (directive == 0 || d.length_ > directive->length_))
+        {
+            directive = &d;
+        }
+    }
+    if (directive == 0)
+    {
+        id = poundId;
+        return p + poundLength;
+    }
+
+    const char * end = name + directive->length_;
+    id = directive->id_;
+    if (id == wave::T_PP_INCLUDE || id == wave::T_PP_INCLUDE_NEXT)
+    {
+        const char * const header = ppSpaceEnd(end);
+        const char * headerNameEnd = 0;
+        if (*header == '<' && (headerNameEnd = headerEnd(header, '>')) != 0)
+        {
+            id = wave::T_PP_HHEADER;
+        }
+        else if (*header == '"' && (headerNameEnd = headerEnd(header, '"')) != 0)
+        {
+            id = wave::T_PP_QHEADER;
+        }
+        else
+        {
+            id = wave::T_PP_INCLUDE;
+            headerNameEnd = header;
+        }
+#if BOOST_WAVE_SUPPORT_INCLUDE_NEXT != 0
+        if (directive->id_ == wave::T_PP_INCLUDE_NEXT)
+        {
+            id = wave::token_id(id | wave::AltTokenType);
+        }
+#endif
+        end = headerNameEnd;
+    }
+    if (usesTokenSpelling(id))
+    {
+        canonical = static_cast<std::size_t>(end - p) == std::strlen(wave::get_token_value(id));
+    }
+    return end;
+}
+
+const char * FastLexer::scanCComment(const char * p)
+{
+    for (;;)
+    {
+        if (p == end_)
+        {
+            // unterminated comment
+            return p;
+        }
+        else if (p[0] == '*' && p[1] == '/')
+        {
+            return p + 2;
+        }
+        else if (*p == '\n')
+        {
+            newLine(p + 1);
+        }
+        else if (*p == '\r' && p[1] != '\n')
+        {
+            newLine(p + 1);
+        }
+        ++p;
+    }
+}
+
+const char * FastLexer::scanCppComment(const char * p)
+{
+    while (p != end_ && *p != '\n' && *p != '\r')
+    {
+        ++p;
+    }
+    if (p == end_)
+    {
+        // unterminated comment, at the end of the file
+        return p;
+    }
+    if (p[0] == '\r' && p[1] == '\n')
+    {
+        ++p;
+    }
+    return newLine(p + 1);
+}
+
+const char * FastLexer::newLine(const char * p)
+{
+    ++line_;
+    lineBegin_ = p;
+    return p;
+}
+
+}
+}
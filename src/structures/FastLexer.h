@@ -0,0 +1,103 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef FASTLEXER_H_INCLUDED
+#define FASTLEXER_H_INCLUDED
+
+#include <boost/wave/token_ids.hpp>
+#include <string>
+#include <vector>
+
+
+namespace Vera
+{
+namespace Structures
+{
+
+// Hand-written lexer giving the same tokens, with the same values and
+// positions, as the Boost.Wave lexer, for the lexical grammar of C++ 98 to
+// C++ 23: the tokens unknown to Wave are given the ids of TokenIds.
+// Unlike Wave, it never gives up: an invalid character is returned as an
+// "any" token and the lexing continues after it, and the unterminated
+// comments and raw strings end with the source.
+class FastLexer
+{
+public:
+    struct Token
+    {
+        boost::wave::token_id id_;
+
+        // as given by Wave: the line continuations are not counted in the
+        // columns, and the column is 0-based
+        int line_;
+        int column_;
+
+        // offsets of the token in the source, once the line continuations
+        // are removed
+        int begin_;
+        int end_;
+
+        // offset of the token in the original source
+        int offset_;
+
+        // true if the value is the text of the original source at offset_
+        bool inSource_;
+    };
+
+    FastLexer(const std::string & src, bool msExtensions);
+
+    // false after the eof token
+    bool next(Token & token);
+
+    std::string getValue(const Token & token) const;
+
+    // the id of the keyword, or T_IDENTIFIER if the word is not a keyword
+    static boost::wave::token_id getKeywordId(const std::string & word, bool msExtensions);
+
+private:
+    struct Splice
+    {
+        // offset of the line continuation once it is removed, and its length
+        int at_;
+        int length_;
+    };
+    typedef std::vector<Splice> SpliceCollection;
+
+    const char * scanPunctuation(const char * p, boost::wave::token_id & id, bool & canonical);
+    // the literals with an encoding prefix (L, u8, u or U) and the raw string
+    // literals, or 0 if there is none at p
+    const char * scanPrefixedLiteral(const char * p, boost::wave::token_id & id);
+
+    // p is at the quote of R"delimiter(...)delimiter"
+    const char * scanRawString(const char * p);
+    const char * scanTrigraph(const char * p, boost::wave::token_id & id, bool & canonical);
+    const char * scanPound(const char * p, int poundLength, boost::wave::token_id poundId,
+        boost::wave::token_id & id, bool & canonical);
+    const char * scanCComment(const char * p);
+    const char * scanCppComment(const char * p);
+    const char * newLine(const char * p);
+
+    bool msExtensions_;
+    std::string spliced_;
+    SpliceCollection splices_;
+    std::size_t nextSplice_;
+    std::size_t countedSplice_;
+    int removed_;
+
+    const char * buffer_;
+    const char * end_;
+    const char * current_;
+    const char * lineBegin_;
+    int line_;
+    bool done_;
+};
+
+} // namespace Structures
+
+} // namespace Vera
+
+#endif // FASTLEXER_H_INCLUDED
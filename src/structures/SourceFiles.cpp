@@ -6,6 +6,10 @@
 //
 
 #include "SourceFiles.h"
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <sstream>
 
 
 namespace // unnamed
@@ -13,6 +17,28 @@ namespace // unnamed
 
 Vera::Structures::SourceFiles::FileNameSet files_;
 
+typedef boost::unordered_map<Vera::Structures::SourceFiles::FileName,
+    Vera::Structures::SourceFiles::FileId> FileIdMap;
+FileIdMap fileIds_;
+// the keys of fileIds_, indexed by id
+std::vector<const Vera::Structures::SourceFiles::FileName *> fileNames_;
+
+// from 1, the whole set of files by default
+int shardIndex_ = 1;
+int shardCount_ = 1;
+
+// FNV-1a, which doesn't depend on the platform, unlike boost::hash
+boost::uint32_t hashName(const Vera::Structures::SourceFiles::FileName & name)
+{
+    boost::uint32_t hash = 2166136261u;
+    for (std::string::size_type i = 0; i != name.size(); ++i)
+    {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 } // unnamed namespace
 
 namespace Vera
@@ -27,7 +53,50 @@ int SourceFiles::count()
 
 void SourceFiles::addFileName(const FileName & name)
 {
-    files_.insert(name);
+    if (isInShard(name))
+    {
+        files_.insert(name);
+        getFileId(name);
+    }
+}
+
+void SourceFiles::setShard(int index, int count)
+{
+    if (count < 1 || index < 1 || index > count)
+    {
+        std::ostringstream ss;
+        ss << "invalid shard: " << index << '/' << count;
+        throw SourceFileError(ss.str());
+    }
+    shardIndex_ = index;
+    shardCount_ = count;
+}
+
+bool SourceFiles::isInShard(const FileName & name)
+{
+    return shardCount_ == 1
+        || static_cast<int>(hashName(name) % static_cast<boost::uint32_t>(shardCount_))
+            == shardIndex_ - 1;
+}
+
+bool SourceFiles::isSourceFileName(const FileName & name)
+{
+    const std::string suffixes[] =
+        { ".cpp", ".cxx", ".cc", ".c", ".C", ".h", ".hh", ".hpp", ".hxx", ".ipp" };
+
+    const int numOfSuffixes = sizeof(suffixes) / sizeof(std::string);
+    for (int i = 0; i != numOfSuffixes; ++i)
+    {
+        const std::string suf = suffixes[i];
+        const FileName::size_type pos = name.rfind(suf);
+
+        if (pos != FileName::npos && pos == name.size() - suf.size())
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 bool SourceFiles::empty()
@@ -40,5 +109,52 @@ const SourceFiles::FileNameSet & SourceFiles::getAllFileNames()
     return files_;
 }
 
+SourceFiles::FileId SourceFiles::getFileId(const FileName & name)
+{
+    const std::pair<FileIdMap::iterator, bool> res =
+        fileIds_.insert(std::make_pair(name, static_cast<FileId>(fileNames_.size())));
+    if (res.second)
+    {
+        fileNames_.push_back(&res.first->first);
+    }
+    return res.first->second;
+}
+
+const SourceFiles::FileName & SourceFiles::getFileName(FileId id)
+{
+    return *fileNames_[static_cast<std::size_t>(id)];
+}
+
+int SourceFiles::getFileIdCount()
+{
+    return static_cast<int>(fileNames_.size());
+}
+
+struct SourceFiles::State
+{
+    State() : shardIndex_(1), shardCount_(1) {}
+
+    FileNameSet files_;
+    FileIdMap fileIds_;
+    std::vector<const FileName *> fileNames_;
+    int shardIndex_;
+    int shardCount_;
+};
+
+boost::shared_ptr<SourceFiles::State> SourceFiles::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void SourceFiles::swapState(State & state)
+{
+    // fileNames_ points into the nodes of fileIds_, which move with it
+    files_.swap(state.files_);
+    fileIds_.swap(state.fileIds_);
+    fileNames_.swap(state.fileNames_);
+    std::swap(shardIndex_, state.shardIndex_);
+    std::swap(shardCount_, state.shardCount_);
+}
+
 }
 }
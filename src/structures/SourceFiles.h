@@ -10,7 +10,9 @@
 
 #include <string>
 #include <set>
+#include <vector>
 #include <stdexcept>
+#include <boost/shared_ptr.hpp>
 
 
 namespace Vera
@@ -32,12 +34,38 @@ public:
     typedef std::set<FileName> FileNameSet;
     typedef FileNameSet::const_iterator iterator;
 
+    // the files get dense ids in the order they are first seen, so the
+    // structures of the files can be indexed by id
+    typedef int FileId;
+    typedef std::vector<FileId> FileIdCollection;
+
+    // the files out of the shard are ignored
     static void addFileName(const FileName & name);
 
+    // Keeps only the files of the shard, from 1 to count, in a partition of
+    // the files by a hash of their name: the same on all the platforms, so
+    // the runs of the shards on different machines check each file once.
+    static void setShard(int index, int count);
+    static bool isInShard(const FileName & name);
+
+    // true if the name has the extension of a C or C++ source file
+    static bool isSourceFileName(const FileName & name);
+
     static bool empty();
     static int count();
 
     static const FileNameSet & getAllFileNames();
+
+    // registers the file if needed
+    static FileId getFileId(const FileName & name);
+    static const FileName & getFileName(FileId id);
+    static int getFileIdCount();
+
+    // The data of the module, as owned by a Session and swapped with the one
+    // in use while the session runs.
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
 };
 
 } // namespace Structures
@@ -8,22 +8,197 @@
 #include "SourceLines.h"
 #include "Tokens.h"
 #include "../plugins/Reports.h"
+#include "../plugins/Profiler.h"
+#include "../plugins/CallStats.h"
+#include "../plugins/Trace.h"
 #include <vector>
-#include <map>
+#include <deque>
+#include <list>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <cstring>
 #include <cerrno>
+#include <boost/foreach.hpp>
+
+#define foreach BOOST_FOREACH
 
 
 namespace // unnamed
 {
 
-typedef std::map<Vera::Structures::SourceFiles::FileName,
-    Vera::Structures::SourceLines::LineCollection> SourceFileCollection;
+// the loaded files that can be unloaded, the most recently used first
+typedef std::list<Vera::Structures::SourceFiles::FileId> FileIdList;
+FileIdList recentlyUsed;
+
+// in bytes, 0 for no limit
+std::size_t maxMemory = 0;
+std::size_t usedMemory = 0;
+
+bool parseOnLoad = false;
+
+// the buffers, in the order they were given
+Vera::Structures::SourceFiles::FileIdCollection buffers_;
+
+struct SourceFile
+{
+    SourceFile()
+        : loaded_(false), endsWithNewline_(false), bytes_(0), inRecentlyUsed_(false),
+        buffer_(false), lexPending_(false) {}
+
+    bool loaded_;
+    Vera::Structures::SourceLines::LineCollection lines_;
+
+    // to give the same source to the lexer when the tokens are parsed later
+    bool endsWithNewline_;
+
+    // memory used by the lines and the tokens of the file
+    std::size_t bytes_;
+
+    // the standard input can't be read again, so it is never unloaded
+    bool inRecentlyUsed_;
+    FileIdList::iterator recentlyUsedPosition_;
+
+    // a buffer with tokens not parsed yet
+    bool buffer_;
+    bool lexPending_;
+};
+
+// indexed by file id - a deque, so growing it doesn't move the lines handed
+// out by getAllLines to the scripts and to the lexer
+typedef std::deque<SourceFile> SourceFileCollection;
 
 SourceFileCollection sources_;
 
+SourceFile & getSourceFile(Vera::Structures::SourceFiles::FileId id)
+{
+    if (static_cast<std::size_t>(id) >= sources_.size())
+    {
+        sources_.resize(id + 1);
+    }
+    return sources_[id];
+}
+
+std::size_t getLinesMemory(const Vera::Structures::SourceLines::LineCollection & lines)
+{
+    std::size_t bytes = lines.capacity() * sizeof(std::string);
+    for (Vera::Structures::SourceLines::LineCollection::const_iterator it = lines.begin();
+         it != lines.end(); ++it)
+    {
+        bytes += it->capacity();
+    }
+    return bytes;
+}
+
+// the lines are split as with getline: a last line without newline
+// is a line, but the final newline does not start a new one
+void splitLines(const Vera::Structures::Tokens::FileContent & fullSource,
+    Vera::Structures::SourceLines::LineCollection & lines)
+{
+    lines.reserve(std::count(fullSource.begin(), fullSource.end(), '\n') + 1);
+    std::string::size_type lineBegin = 0;
+    while (lineBegin < fullSource.size())
+    {
+        std::string::size_type lineEnd = fullSource.find('\n', lineBegin);
+        if (lineEnd == std::string::npos)
+        {
+            lineEnd = fullSource.size();
+        }
+        lines.push_back(fullSource.substr(lineBegin, lineEnd - lineBegin));
+        lineBegin = lineEnd + 1;
+    }
+}
+
+void readSource(std::istream & file, Vera::Structures::Tokens::FileContent & fullSource,
+    Vera::Structures::SourceLines::LineCollection & lines)
+{
+    // the source is read at once, in a buffer sized from the length of the
+    // file when it can be known (the standard input can't seek)
+    std::streambuf & buffer = *file.rdbuf();
+    const std::streampos begin = buffer.pubseekoff(0, std::ios::cur, std::ios::in);
+    const std::streampos end = buffer.pubseekoff(0, std::ios::end, std::ios::in);
+    if (begin != std::streampos(-1) && end != std::streampos(-1))
+    {
+        buffer.pubseekpos(begin, std::ios::in);
+        fullSource.reserve(static_cast<std::size_t>(end - begin));
+    }
+
+    char chunk[65536];
+    while (file.read(chunk, sizeof(chunk)) || file.gcount() > 0)
+    {
+        fullSource.append(chunk, static_cast<std::size_t>(file.gcount()));
+    }
+    splitLines(fullSource, lines);
+}
+
+// the source with its newlines, as given to the lexer
+Vera::Structures::Tokens::FileContent joinLines(const SourceFile & source)
+{
+    const Vera::Structures::SourceLines::LineCollection & lines = source.lines_;
+    std::size_t length = lines.size();
+    for (Vera::Structures::SourceLines::LineCollection::const_iterator it = lines.begin();
+         it != lines.end(); ++it)
+    {
+        length += it->size();
+    }
+
+    Vera::Structures::Tokens::FileContent fullSource;
+    fullSource.reserve(length);
+    for (Vera::Structures::SourceLines::LineCollection::const_iterator it = lines.begin();
+         it != lines.end(); ++it)
+    {
+        if (it != lines.begin())
+        {
+            fullSource += '\n';
+        }
+        fullSource += *it;
+    }
+    if (source.endsWithNewline_)
+    {
+        fullSource += '\n';
+    }
+    return fullSource;
+}
+
+void touch(SourceFile & source)
+{
+    if (source.inRecentlyUsed_)
+    {
+        recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, source.recentlyUsedPosition_);
+    }
+}
+
+void forget(SourceFile & source)
+{
+    if (source.inRecentlyUsed_)
+    {
+        recentlyUsed.erase(source.recentlyUsedPosition_);
+        source.inRecentlyUsed_ = false;
+        usedMemory -= source.bytes_;
+    }
+}
+
+void unloadFile(Vera::Structures::SourceFiles::FileId id)
+{
+    SourceFile & source = sources_[id];
+    forget(source);
+
+    // swapped with empty lines to release the memory
+    Vera::Structures::SourceLines::LineCollection().swap(source.lines_);
+    source.loaded_ = false;
+    Vera::Structures::Tokens::unload(id);
+}
+
+// the least recently used files are unloaded until the memory budget is met,
+// but the file just loaded is always kept
+void evictFiles(Vera::Structures::SourceFiles::FileId loaded)
+{
+    while (maxMemory != 0 && usedMemory > maxMemory && recentlyUsed.back() != loaded)
+    {
+        unloadFile(recentlyUsed.back());
+    }
+}
+
 } // unnamed namespace
 
 
@@ -32,26 +207,122 @@ namespace Vera
 namespace Structures
 {
 
+// the functions with a file name are the ones called by the scripts
+
 const SourceLines::LineCollection & SourceLines::getAllLines(const SourceFiles::FileName & name)
 {
-    const SourceFileCollection::const_iterator it = sources_.find(name);
-    if (it != sources_.end())
+    Plugins::Trace::Span span("binding", "getAllLines", name);
+    Plugins::CallStats::countGetAllLines();
+    return getAllLines(SourceFiles::getFileId(name));
+}
+
+int SourceLines::getLineCount(const SourceFiles::FileName & name)
+{
+    Plugins::Trace::Span span("binding", "getLineCount", name);
+    Plugins::CallStats::countGetLineCount();
+    return getLineCount(SourceFiles::getFileId(name));
+}
+
+const std::string & SourceLines::getLine(const SourceFiles::FileName & name, int lineNumber)
+{
+    Plugins::Trace::Span span("binding", "getLine", name);
+    const SourceFiles::FileId id = SourceFiles::getFileId(name);
+    const std::string & line = getLine(id, lineNumber);
+    Plugins::CallStats::countGetLine(id);
+    return line;
+}
+
+void SourceLines::setMaxMemory(std::size_t bytes)
+{
+    maxMemory = bytes;
+}
+
+std::size_t SourceLines::getMaxMemory()
+{
+    return maxMemory;
+}
+
+void SourceLines::setParseOnLoad(bool parse)
+{
+    parseOnLoad = parse;
+}
+
+void SourceLines::parseTokens(SourceFiles::FileId id)
+{
+    getAllLines(id);
+    SourceFile & source = sources_[id];
+    source.lexPending_ = false;
+
+    Tokens::parse(id, joinLines(source));
+
+    if (source.inRecentlyUsed_)
+    {
+        const std::size_t tokensMemory = Tokens::getMemoryUsage(id);
+        source.bytes_ += tokensMemory;
+        usedMemory += tokensMemory;
+        evictFiles(id);
+    }
+}
+
+void SourceLines::parseBuffers()
+{
+    if (parseOnLoad == false)
+    {
+        return;
+    }
+
+    SourceFiles::FileIdCollection ids;
+    Tokens::FileContentCollection sources;
+    foreach (SourceFiles::FileId id, buffers_)
     {
-        return it->second;
+        SourceFile & source = sources_[id];
+        if (source.lexPending_)
+        {
+            source.lexPending_ = false;
+            ids.push_back(id);
+            sources.push_back(joinLines(source));
+        }
+    }
+    if (ids.empty() == false)
+    {
+        Tokens::parse(ids, sources);
+    }
+}
+
+const SourceLines::LineCollection & SourceLines::getAllLines(SourceFiles::FileId id)
+{
+    Plugins::Profiler::useFile(id);
+
+    SourceFile & source = getSourceFile(id);
+    Plugins::Profiler::countCacheUse(Plugins::Profiler::linesCache, source.loaded_);
+    if (source.loaded_ == false)
+    {
+        // lazy load of the source file, or reload of an unloaded one
+        loadFile(id);
     }
     else
     {
-        // lazy load of the source file
-        loadFile(name);
-        return sources_[name];
+        touch(source);
     }
+    return sources_[id].lines_;
 }
 
-void SourceLines::loadFile(const SourceFiles::FileName & name)
+const SourceLines::LineCollection & SourceLines::peekAllLines(SourceFiles::FileId id)
 {
+    if (getSourceFile(id).loaded_ == false)
+    {
+        loadFile(id);
+    }
+    return sources_[id].lines_;
+}
+
+void SourceLines::loadFile(SourceFiles::FileId id)
+{
+    const SourceFiles::FileName & name = SourceFiles::getFileName(id);
+    Plugins::Trace::Span span("ingest", "load", name);
     if (name == "-")
     {
-        SourceLines::loadFile(std::cin, name);
+        SourceLines::loadFile(std::cin, id);
     }
     else
     {
@@ -63,58 +334,136 @@ void SourceLines::loadFile(const SourceFiles::FileName & name)
                << strerror(errno);
             throw SourceFileError(ss.str());
         }
-        SourceLines::loadFile(file, name);
+        SourceLines::loadFile(file, id);
         if (file.bad())
         {
             throw std::runtime_error(
                 "Cannot read from " + name + ": " + strerror(errno));
         }
+
+        SourceFile & source = sources_[id];
+        forget(source);
+        source.bytes_ = getLinesMemory(source.lines_) + Tokens::getMemoryUsage(id);
+        recentlyUsed.push_front(id);
+        source.recentlyUsedPosition_ = recentlyUsed.begin();
+        source.inRecentlyUsed_ = true;
+        usedMemory += source.bytes_;
+        evictFiles(id);
     }
 }
 
-void SourceLines::loadFile(std::istream & file, const SourceFiles::FileName & name)
+void SourceLines::loadFile(std::istream & file, SourceFiles::FileId id)
 {
-    LineCollection & lines = sources_[name];
+    SourceFile & source = getSourceFile(id);
+    source.loaded_ = true;
+    LineCollection & lines = source.lines_;
+    lines.clear();
 
-    std::string line;
     Tokens::FileContent fullSource;
-    while (getline(file, line))
     {
-        lines.push_back(line);
-        fullSource += line;
+        Plugins::Profiler::Phase phase("load");
+        readSource(file, fullSource, lines);
+        phase.addBytes(fullSource.size() + getLinesMemory(lines));
+    }
+    Plugins::Profiler::addCount(Plugins::Profiler::bytesRead, fullSource.size());
+    Plugins::Profiler::addCount(Plugins::Profiler::linesRead, lines.size());
+    source.endsWithNewline_ = fullSource.empty() == false && *fullSource.rbegin() == '\n';
 
-        // built-in rule
-        if (file.eof())
+    if (parseOnLoad)
+    {
+        Tokens::parse(id, fullSource);
+    }
+    else
+    {
+        Tokens::unload(id);
+    }
+}
+
+void SourceLines::loadBuffers(const BufferCollection & buffers)
+{
+    Plugins::Profiler::Phase phase("load");
+    foreach (const Buffer & buffer, buffers)
+    {
+        if (SourceFiles::isInShard(buffer.name_) == false)
         {
-            // Plugins::Reports::internal(name, static_cast<int>(lines.size()),
-            //     "no newline at end of file");
+            continue;
         }
-        else
+        SourceFiles::addFileName(buffer.name_);
+        const SourceFiles::FileId id = SourceFiles::getFileId(buffer.name_);
+
+        SourceFile & source = getSourceFile(id);
+        forget(source);
+        source.loaded_ = true;
+        source.lines_.clear();
+        splitLines(buffer.content_, source.lines_);
+        source.endsWithNewline_ =
+            buffer.content_.empty() == false && *buffer.content_.rbegin() == '\n';
+        if (source.buffer_ == false)
         {
-            fullSource += '\n';
+            source.buffer_ = true;
+            buffers_.push_back(id);
         }
+        source.lexPending_ = true;
+        Tokens::unload(id);
+
+        phase.addBytes(buffer.content_.size() + getLinesMemory(source.lines_));
+        Plugins::Profiler::addCount(Plugins::Profiler::bytesRead, buffer.content_.size());
+        Plugins::Profiler::addCount(Plugins::Profiler::linesRead, source.lines_.size());
     }
+    parseBuffers();
+}
 
-    Tokens::parse(name, fullSource);
+bool SourceLines::isBuffer(SourceFiles::FileId id)
+{
+    return static_cast<std::size_t>(id) < sources_.size() && sources_[id].buffer_;
 }
 
-int SourceLines::getLineCount(const SourceFiles::FileName & name)
+int SourceLines::getLineCount(SourceFiles::FileId id)
 {
-    return static_cast<int>(getAllLines(name).size());
+    return static_cast<int>(getAllLines(id).size());
 }
 
-const std::string & SourceLines::getLine(const SourceFiles::FileName & name, int lineNumber)
+const std::string & SourceLines::getLine(SourceFiles::FileId id, int lineNumber)
 {
-    const LineCollection & lines = getAllLines(name);
+    const LineCollection & lines = getAllLines(id);
     if (lineNumber < 1 || lineNumber > static_cast<int>(lines.size()))
     {
         std::cerr << "Requested wrong line number: " << lineNumber << '\n';
-        std::cerr << "lines.size in " << name << " is " << static_cast<int>(lines.size()) << '\n';
+        std::cerr << "lines.size in " << SourceFiles::getFileName(id) << " is "
+            << static_cast<int>(lines.size()) << '\n';
         throw SourceFileError("requested line number is out of range");
     }
 
     return lines[lineNumber - 1];
 }
 
+struct SourceLines::State
+{
+    State() : maxMemory_(0), usedMemory_(0), parseOnLoad_(false) {}
+
+    FileIdList recentlyUsed_;
+    std::size_t maxMemory_;
+    std::size_t usedMemory_;
+    bool parseOnLoad_;
+    SourceFiles::FileIdCollection buffers_;
+    SourceFileCollection sources_;
+};
+
+boost::shared_ptr<SourceLines::State> SourceLines::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void SourceLines::swapState(State & state)
+{
+    // the positions in the list stay valid through the swap
+    recentlyUsed.swap(state.recentlyUsed_);
+    std::swap(maxMemory, state.maxMemory_);
+    std::swap(usedMemory, state.usedMemory_);
+    std::swap(parseOnLoad, state.parseOnLoad_);
+    buffers_.swap(state.buffers_);
+    sources_.swap(state.sources_);
+}
+
 }
 }
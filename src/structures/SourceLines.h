@@ -11,6 +11,7 @@
 #include "SourceFiles.h"
 #include <vector>
 #include <iostream>
+#include <boost/shared_ptr.hpp>
 
 namespace Vera
 {
@@ -23,12 +24,55 @@ class SourceLines
 public:
     typedef std::vector<std::string> LineCollection;
 
+    // a file given with its content, as an unsaved file of an editor
+    struct Buffer
+    {
+        SourceFiles::FileName name_;
+        std::string content_;
+    };
+
+    typedef std::vector<Buffer> BufferCollection;
+
     static const LineCollection & getAllLines(const SourceFiles::FileName & name);
     static int getLineCount(const SourceFiles::FileName & name);
     static const std::string & getLine(const SourceFiles::FileName & name, int lineNumber);
 
-    static void loadFile(const SourceFiles::FileName & name);
-    static void loadFile(std::istream & file, const SourceFiles::FileName & name);
+    static const LineCollection & getAllLines(SourceFiles::FileId id);
+    static int getLineCount(SourceFiles::FileId id);
+    static const std::string & getLine(SourceFiles::FileId id, int lineNumber);
+
+    // The lines of a file for the engine itself, as the text of the tokens:
+    // the file is loaded if needed, but the access is neither measured by the
+    // profiler nor counted as a use of the cache of the lines.
+    static const LineCollection & peekAllLines(SourceFiles::FileId id);
+
+    static void loadFile(SourceFiles::FileId id);
+    static void loadFile(std::istream & file, SourceFiles::FileId id);
+
+    // The buffers are added to the source files, and their lines are never
+    // read from the disk nor unloaded. Their tokens are lexed in parallel,
+    // as soon as they are known to be needed.
+    static void loadBuffers(const BufferCollection & buffers);
+    static bool isBuffer(SourceFiles::FileId id);
+
+    // With a limit, the least recently used files are unloaded when a file is
+    // loaded, and they are loaded again when they are used: the lines and the
+    // tokens of a file are then only valid until another file is used.
+    // 0, the default, for no limit.
+    static void setMaxMemory(std::size_t bytes);
+    static std::size_t getMaxMemory();
+
+    // The tokens of a file are parsed on the first request, from its lines,
+    // unless they are known to be needed: they are then parsed with the source
+    // when the file is loaded.
+    static void setParseOnLoad(bool parse);
+    static void parseTokens(SourceFiles::FileId id);
+    static void parseBuffers();
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
 };
 
 } // namespace Structures
@@ -0,0 +1,542 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "SourceTree.h"
+#include "SourceFiles.h"
+#include "../plugins/Trace.h"
+#include <deque>
+#include <fstream>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/foreach.hpp>
+
+#define foreach BOOST_FOREACH
+
+
+namespace // unnamed
+{
+
+// matches a path with a glob of an ignore file: '*' and '?' don't match
+// the '/', and "**" matches anything, including the '/'
+bool matchGlob(const char * glob, const char * path)
+{
+    while (*glob != '\0')
+    {
+        switch (*glob)
+        {
+        case '*':
+            if (glob[1] == '*')
+            {
+                const char * rest = glob + 2;
+                if (*rest == '/')
+                {
+                    // "**/" matches zero or more directories
+                    ++rest;
+                    for (const char * p = path; ; ++p)
+                    {
+                        if ((p == path || p[-1] == '/') && matchGlob(rest, p))
+                        {
+                            return true;
+                        }
+                        if (*p == '\0')
+                        {
+                            return false;
+                        }
+                    }
+                }
+                for (const char * p = path; ; ++p)
+                {
+                    if (matchGlob(rest, p))
+                    {
+                        return true;
+                    }
+                    if (*p == '\0')
+                    {
+                        return false;
+                    }
+                }
+            }
+            ++glob;
+            for (const char * p = path; ; ++p)
+            {
+                if (matchGlob(glob, p))
+                {
+                    return true;
+                }
+                if (*p == '\0' || *p == '/')
+                {
+                    return false;
+                }
+            }
+        case '?':
+            if (*path == '\0' || *path == '/')
+            {
+                return false;
+            }
+            break;
+        case '[':
+            {
+                if (*path == '\0' || *path == '/')
+                {
+                    return false;
+                }
+                const char * p = glob + 1;
+                const bool negated = *p == '!' || *p == '^';
+                if (negated)
+                {
+                    ++p;
+                }
+                bool matched = false;
+                bool first = true;
+                while (*p != '\0' && (*p != ']' || first))
+                {
+                    first = false;
+                    char low = *p;
+                    if (low == '\\' && p[1] != '\0')
+                    {
+                        low = *++p;
+                    }
+                    char high = low;
+                    if (p[1] == '-' && p[2] != ']' && p[2] != '\0')
+                    {
+                        p += 2;
+                        high = *p;
+                        if (high == '\\' && p[1] != '\0')
+                        {
+                            high = *++p;
+                        }
+                    }
+                    if (low <= *path && *path <= high)
+                    {
+                        matched = true;
+                    }
+                    ++p;
+                }
+                if (*p != ']')
+                {
+                    // not a set, just a '['
+                    if (*path != '[')
+                    {
+                        return false;
+                    }
+                    break;
+                }
+                if (matched == negated)
+                {
+                    return false;
+                }
+                glob = p;
+            }
+            break;
+        case '\\':
+            if (glob[1] != '\0')
+            {
+                ++glob;
+            }
+            if (*glob != *path)
+            {
+                return false;
+            }
+            break;
+        default:
+            if (*glob != *path)
+            {
+                return false;
+            }
+            break;
+        }
+        ++glob;
+        ++path;
+    }
+    return *path == '\0';
+}
+
+struct IgnorePattern
+{
+    std::string glob_;
+    bool negated_;
+    bool directoryOnly_;
+    // matched with the path relative to the ignore file instead of the name
+    bool anchored_;
+};
+
+typedef std::vector<IgnorePattern> IgnorePatternCollection;
+
+struct IgnoreRules;
+typedef boost::shared_ptr<const IgnoreRules> IgnoreRulesPtr;
+
+// the patterns of the ignore files of a directory, chained to the ones
+// of the parent directories
+struct IgnoreRules
+{
+    IgnoreRulesPtr parent_;
+    // relative to the walked directory, with a trailing '/' when not empty
+    std::string base_;
+    IgnorePatternCollection patterns_;
+};
+
+void readIgnoreFile(const std::string & fileName, IgnorePatternCollection & patterns)
+{
+    std::ifstream file(fileName.c_str());
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() == false && line[line.size() - 1] == '\r')
+        {
+            line.erase(line.size() - 1);
+        }
+        while (line.empty() == false && line[line.size() - 1] == ' '
+            && (line.size() < 2 || line[line.size() - 2] != '\\'))
+        {
+            line.erase(line.size() - 1);
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        IgnorePattern pattern;
+        pattern.negated_ = false;
+        pattern.directoryOnly_ = false;
+        if (line[0] == '!')
+        {
+            pattern.negated_ = true;
+            line.erase(0, 1);
+        }
+        else if (line.size() > 1 && line[0] == '\\' && (line[1] == '!' || line[1] == '#'))
+        {
+            line.erase(0, 1);
+        }
+        if (line.empty() == false && line[line.size() - 1] == '/')
+        {
+            pattern.directoryOnly_ = true;
+            line.erase(line.size() - 1);
+        }
+        pattern.anchored_ = line.find('/') != std::string::npos;
+        if (pattern.anchored_ && line[0] == '/')
+        {
+            line.erase(0, 1);
+        }
+        if (line.empty())
+        {
+            continue;
+        }
+        pattern.glob_ = line;
+        patterns.push_back(pattern);
+    }
+}
+
+bool isIgnored(const IgnoreRules * rules, const std::string & relativePath,
+    const std::string & name, bool isDirectory)
+{
+    // the last matching pattern of the deepest ignore file wins
+    for (; rules != NULL; rules = rules->parent_.get())
+    {
+        const std::string path = relativePath.substr(rules->base_.size());
+        const IgnorePatternCollection & patterns = rules->patterns_;
+        for (IgnorePatternCollection::const_reverse_iterator it = patterns.rbegin();
+             it != patterns.rend(); ++it)
+        {
+            if (it->directoryOnly_ && isDirectory == false)
+            {
+                continue;
+            }
+            if (matchGlob(it->glob_.c_str(), it->anchored_ ? path.c_str() : name.c_str()))
+            {
+                return it->negated_ == false;
+            }
+        }
+    }
+    return false;
+}
+
+enum EntryType { otherEntry, fileEntry, directoryEntry };
+
+// the key identifies the file or the directory, whatever the path used to
+// reach it
+EntryType getEntryType(const std::string & path, std::string & key)
+{
+#ifdef _WIN32
+    boost::system::error_code ec;
+    const boost::filesystem::file_status status = boost::filesystem::status(path, ec);
+    if (ec)
+    {
+        return otherEntry;
+    }
+    key = boost::filesystem::canonical(path, ec).string();
+    if (ec)
+    {
+        key = path;
+    }
+    if (boost::filesystem::is_directory(status))
+    {
+        return directoryEntry;
+    }
+    return boost::filesystem::is_regular_file(status) ? fileEntry : otherEntry;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+        // a broken link, most likely
+        return otherEntry;
+    }
+    key.assign(reinterpret_cast<const char *>(&st.st_dev), sizeof(st.st_dev));
+    key.append(reinterpret_cast<const char *>(&st.st_ino), sizeof(st.st_ino));
+    if (S_ISDIR(st.st_mode))
+    {
+        return directoryEntry;
+    }
+    return S_ISREG(st.st_mode) ? fileEntry : otherEntry;
+#endif
+}
+
+std::string join(const std::string & directory, const std::string & name)
+{
+    if (directory.empty() == false
+        && directory[directory.size() - 1] != '/' && directory[directory.size() - 1] != '\\')
+    {
+        return directory + '/' + name;
+    }
+    return directory + name;
+}
+
+struct Directory
+{
+    std::string path_;
+    // relative to the walked directory, with a trailing '/' when not empty
+    std::string relativePath_;
+    IgnoreRulesPtr rules_;
+    // the keys of the directory and its parents, to break the loops
+    std::vector<std::string> keys_;
+};
+
+struct SourceFile
+{
+    std::string key_;
+    Vera::Structures::SourceFiles::FileName name_;
+};
+
+// The directories are shared by the threads through a queue. A file reached
+// by several paths is kept with the smallest one, so the result doesn't
+// depend on the scheduling of the threads.
+class Walker
+{
+public:
+    typedef boost::unordered_map<std::string, Vera::Structures::SourceFiles::FileName>
+        FileNameMap;
+
+    Walker() : busy_(0) {}
+
+    void add(const std::string & path)
+    {
+        Directory directory;
+        directory.path_ = path;
+        std::string key;
+        if (getEntryType(path, key) != directoryEntry)
+        {
+            throw Vera::Structures::SourceTreeError("Cannot read directory " + path);
+        }
+        directory.keys_.push_back(key);
+        queue_.push_back(directory);
+    }
+
+    void run()
+    {
+        const unsigned int threads = std::max(1u, boost::thread::hardware_concurrency());
+        boost::thread_group group;
+        for (unsigned int i = 0; i != threads; ++i)
+        {
+            group.create_thread(boost::bind(&Walker::work, this));
+        }
+        group.join_all();
+
+        if (error_.empty() == false)
+        {
+            throw Vera::Structures::SourceTreeError(error_);
+        }
+    }
+
+    const FileNameMap & files() const
+    {
+        return files_;
+    }
+
+private:
+    void work()
+    {
+        for (;;)
+        {
+            Directory directory;
+            {
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                while (queue_.empty() && busy_ != 0)
+                {
+                    condition_.wait(lock);
+                }
+                if (queue_.empty())
+                {
+                    return;
+                }
+                directory = queue_.front();
+                queue_.pop_front();
+                ++busy_;
+            }
+
+            std::vector<Directory> directories;
+            std::vector<SourceFile> files;
+            std::string error;
+            try
+            {
+                Vera::Plugins::Trace::Span span("task", "walk", directory.path_);
+                walk(directory, directories, files);
+            }
+            catch (const std::exception & e)
+            {
+                error = e.what();
+            }
+
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            --busy_;
+            queue_.insert(queue_.end(), directories.begin(), directories.end());
+            foreach (const SourceFile & file, files)
+            {
+                const std::pair<FileNameMap::iterator, bool> res =
+                    files_.insert(std::make_pair(file.key_, file.name_));
+                if (res.second == false && file.name_ < res.first->second)
+                {
+                    res.first->second = file.name_;
+                }
+            }
+            if (error_.empty())
+            {
+                error_ = error;
+            }
+            condition_.notify_all();
+        }
+    }
+
+    void walk(const Directory & directory, std::vector<Directory> & directories,
+        std::vector<SourceFile> & files)
+    {
+        std::vector<std::string> names;
+        boost::system::error_code ec;
+        for (boost::filesystem::directory_iterator it(directory.path_, ec), end;
+             it != end; it.increment(ec))
+        {
+            names.push_back(it->path().filename().string());
+        }
+        if (ec)
+        {
+            throw Vera::Structures::SourceTreeError(
+                "Cannot read directory " + directory.path_ + ": " + ec.message());
+        }
+
+        IgnoreRulesPtr rules = directory.rules_;
+        if (std::find(names.begin(), names.end(), ".gitignore") != names.end()
+            || std::find(names.begin(), names.end(), ".veraignore") != names.end())
+        {
+            boost::shared_ptr<IgnoreRules> newRules(new IgnoreRules());
+            newRules->parent_ = directory.rules_;
+            newRules->base_ = directory.relativePath_;
+            readIgnoreFile(join(directory.path_, ".gitignore"), newRules->patterns_);
+            readIgnoreFile(join(directory.path_, ".veraignore"), newRules->patterns_);
+            rules = newRules;
+        }
+
+        foreach (const std::string & name, names)
+        {
+            if (name == ".git")
+            {
+                continue;
+            }
+            const std::string path = join(directory.path_, name);
+            const std::string relativePath = directory.relativePath_ + name;
+            std::string key;
+            switch (getEntryType(path, key))
+            {
+            case directoryEntry:
+                if (isIgnored(rules.get(), relativePath, name, true) == false
+                    && std::find(directory.keys_.begin(), directory.keys_.end(), key)
+                        == directory.keys_.end())
+                {
+                    Directory subdirectory;
+                    subdirectory.path_ = path;
+                    subdirectory.relativePath_ = relativePath + '/';
+                    subdirectory.rules_ = rules;
+                    subdirectory.keys_ = directory.keys_;
+                    subdirectory.keys_.push_back(key);
+                    directories.push_back(subdirectory);
+                }
+                break;
+            case fileEntry:
+                if (Vera::Structures::SourceFiles::isSourceFileName(name)
+                    && isIgnored(rules.get(), relativePath, name, false) == false)
+                {
+                    SourceFile file;
+                    file.key_ = key;
+                    file.name_ = path;
+                    files.push_back(file);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    boost::mutex mutex_;
+    boost::condition_variable condition_;
+    std::deque<Directory> queue_;
+    // the number of threads walking a directory
+    int busy_;
+    FileNameMap files_;
+    std::string error_;
+};
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Structures
+{
+
+void SourceTree::addDirectories(const DirectoryNameCollection & directories)
+{
+    if (directories.empty())
+    {
+        return;
+    }
+
+    Walker walker;
+    foreach (const DirectoryName & directory, directories)
+    {
+        walker.add(directory);
+    }
+    walker.run();
+
+    foreach (const Walker::FileNameMap::value_type & file, walker.files())
+    {
+        SourceFiles::addFileName(file.second);
+    }
+}
+
+bool SourceTree::isDirectory(const DirectoryName & name)
+{
+    boost::system::error_code ec;
+    return boost::filesystem::is_directory(name, ec);
+}
+
+}
+}
@@ -0,0 +1,47 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef SOURCETREE_H_INCLUDED
+#define SOURCETREE_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+
+namespace Vera
+{
+namespace Structures
+{
+
+class SourceTreeError : public std::runtime_error
+{
+public:
+    SourceTreeError(const std::string & msg) : std::runtime_error(msg) {}
+};
+
+// Finds the source files in directory trees, with several threads.
+// The files and directories matched by the .gitignore and .veraignore files
+// are skipped, and a file or a directory reached by several paths (with
+// symbolic or hard links) is only used once.
+class SourceTree
+{
+public:
+    typedef std::string DirectoryName;
+    typedef std::vector<DirectoryName> DirectoryNameCollection;
+
+    // adds the source files found in the directories to SourceFiles
+    static void addDirectories(const DirectoryNameCollection & directories);
+
+    static bool isDirectory(const DirectoryName & name);
+};
+
+} // namespace Structures
+
+} // namespace Vera
+
+#endif // SOURCETREE_H_INCLUDED
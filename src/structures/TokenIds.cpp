@@ -0,0 +1,67 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "TokenIds.h"
+
+
+namespace Vera
+{
+namespace Structures
+{
+
+const boost::wave::token_id TokenIds::T_CHAR8_T;
+const boost::wave::token_id TokenIds::T_CONCEPT;
+const boost::wave::token_id TokenIds::T_CONSTEVAL;
+const boost::wave::token_id TokenIds::T_CONSTINIT;
+const boost::wave::token_id TokenIds::T_CO_AWAIT;
+const boost::wave::token_id TokenIds::T_CO_RETURN;
+const boost::wave::token_id TokenIds::T_CO_YIELD;
+const boost::wave::token_id TokenIds::T_REQUIRES;
+const boost::wave::token_id TokenIds::T_SPACESHIP;
+const boost::wave::token_id TokenIds::T_PP_ELIFDEF;
+const boost::wave::token_id TokenIds::T_PP_ELIFNDEF;
+
+bool TokenIds::isExtended(boost::wave::token_id id)
+{
+    const int baseId = static_cast<int>(BASEID_FROM_TOKEN(id));
+    return baseId >= firstId && baseId <= lastId;
+}
+
+std::string TokenIds::getName(boost::wave::token_id id)
+{
+    // the extended ids are not among the values of the enum
+    switch (static_cast<int>(id))
+    {
+    case T_CHAR8_T:
+        return "CHAR8_T";
+    case T_CONCEPT:
+        return "CONCEPT";
+    case T_CONSTEVAL:
+        return "CONSTEVAL";
+    case T_CONSTINIT:
+        return "CONSTINIT";
+    case T_CO_AWAIT:
+        return "CO_AWAIT";
+    case T_CO_RETURN:
+        return "CO_RETURN";
+    case T_CO_YIELD:
+        return "CO_YIELD";
+    case T_REQUIRES:
+        return "REQUIRES";
+    case T_SPACESHIP:
+        return "SPACESHIP";
+    case T_PP_ELIFDEF:
+        return "PP_ELIFDEF";
+    case T_PP_ELIFNDEF:
+        return "PP_ELIFNDEF";
+    default:
+        return boost::wave::get_token_name(id).c_str();
+    }
+}
+
+}
+}
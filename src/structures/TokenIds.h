@@ -0,0 +1,66 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef TOKENIDS_H_INCLUDED
+#define TOKENIDS_H_INCLUDED
+
+#include <boost/wave/token_ids.hpp>
+#include <string>
+
+
+namespace Vera
+{
+namespace Structures
+{
+
+// The tokens of C++20 and C++23 that are unknown to the Wave library.
+// Their ids are far enough from the ones of Wave to not collide with the
+// newer versions of the library, and they are named in the same way.
+class TokenIds
+{
+public:
+    enum IdRange
+    {
+        firstId = 1024,
+        lastId = firstId + 10
+    };
+
+    static const boost::wave::token_id T_CHAR8_T =
+        TOKEN_FROM_ID(firstId, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_CONCEPT =
+        TOKEN_FROM_ID(firstId + 1, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_CONSTEVAL =
+        TOKEN_FROM_ID(firstId + 2, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_CONSTINIT =
+        TOKEN_FROM_ID(firstId + 3, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_CO_AWAIT =
+        TOKEN_FROM_ID(firstId + 4, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_CO_RETURN =
+        TOKEN_FROM_ID(firstId + 5, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_CO_YIELD =
+        TOKEN_FROM_ID(firstId + 6, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_REQUIRES =
+        TOKEN_FROM_ID(firstId + 7, boost::wave::KeywordTokenType);
+    static const boost::wave::token_id T_SPACESHIP =
+        TOKEN_FROM_ID(firstId + 8, boost::wave::OperatorTokenType);
+    static const boost::wave::token_id T_PP_ELIFDEF =
+        TOKEN_FROM_ID(firstId + 9, boost::wave::PPConditionalTokenType);
+    static const boost::wave::token_id T_PP_ELIFNDEF =
+        TOKEN_FROM_ID(firstId + 10, boost::wave::PPConditionalTokenType);
+
+    // true for the ids above
+    static bool isExtended(boost::wave::token_id id);
+
+    // the name of the token, in capitals as with boost::wave::get_token_name
+    static std::string getName(boost::wave::token_id id);
+};
+
+} // namespace Structures
+
+} // namespace Vera
+
+#endif // TOKENIDS_H_INCLUDED
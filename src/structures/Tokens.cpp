@@ -7,7 +7,12 @@
 
 #include "Tokens.h"
 #include "SourceLines.h"
+#include "FastLexer.h"
+#include "TokenIds.h"
 #include "../plugins/Reports.h"
+#include "../plugins/Profiler.h"
+#include "../plugins/CallStats.h"
+#include "../plugins/Trace.h"
 #include <boost/wave.hpp>
 #include <boost/wave/cpplexer/cpp_lex_token.hpp>
 #include <boost/wave/cpplexer/cpp_lex_iterator.hpp>
@@ -15,9 +20,14 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <memory>
 #include <sstream>
 #include <cctype>
 
@@ -25,30 +35,88 @@
 namespace // unnamed
 {
 
-typedef std::vector<std::string> PhysicalTokenCollection;
-PhysicalTokenCollection physicalTokens;
+bool fastLexer = false;
+
+// the text of the source at the given position, over several lines
+// for the multi-line tokens, as the comments and the raw strings
+std::string getSourceText(Vera::Structures::SourceFiles::FileId fileId,
+    int line, int column, int length)
+{
+    const Vera::Structures::SourceLines::LineCollection & lines =
+        Vera::Structures::SourceLines::peekAllLines(fileId);
+    const std::size_t size = static_cast<std::size_t>(length);
+    std::string text = lines[line - 1].substr(column, length);
+    while (text.size() < size)
+    {
+        // the last new line of the source has no line after it
+        text += '\n';
+        if (text.size() < size)
+        {
+            ++line;
+            text += lines[line - 1].substr(0, size - text.size());
+        }
+    }
+    return text;
+}
+
+// true if the value is the text of the source at the given position
+bool isInSource(const Vera::Structures::SourceLines::LineCollection & lines,
+    int line, int column, const std::string & value)
+{
+    const int lineCount = static_cast<int>(lines.size());
+    std::size_t matched = 0;
+    std::size_t start = static_cast<std::size_t>(column);
+    for (int i = line; i <= lineCount; ++i)
+    {
+        const std::string & sourceLine = lines[i - 1];
+        if (start > sourceLine.size())
+        {
+            return false;
+        }
+        const std::size_t chunk = std::min(sourceLine.size() - start, value.size() - matched);
+        if (value.compare(matched, chunk, sourceLine, start, chunk) != 0)
+        {
+            return false;
+        }
+        matched += chunk;
+        if (matched == value.size())
+        {
+            return true;
+        }
+        if (value[matched] != '\n')
+        {
+            return false;
+        }
+        ++matched;
+        start = 0;
+    }
+    return false;
+}
 
 struct TokenRef
 {
     TokenRef(boost::wave::token_id id, int line, int column, int length)
         : id_(id), line_(line), column_(column), length_(length), index_(-1) {}
 
-    TokenRef(boost::wave::token_id id, int line, int column, int length, const std::string & value)
-        : id_(id), line_(line), column_(column), length_(length)
+    TokenRef(boost::wave::token_id id, int line, int column,
+        const std::string & value, std::string & values)
+        : id_(id), line_(line), column_(column), length_(static_cast<int>(value.size())),
+        index_(-1)
     {
         // newline is optimized as the most common case
 
         if (id_ != boost::wave::T_NEWLINE)
         {
-            // value of the token is stored in physicalTokens collection
+            // value of the token is stored in the values of the file
             // (because it has no physical representation in the source code)
 
-            index_ = static_cast<int>(physicalTokens.size());
-            physicalTokens.push_back(value);
+            index_ = static_cast<int>(values.size());
+            values += value;
         }
     }
 
-    std::string getTokenValue(const Vera::Structures::SourceFiles::FileName & fileName) const
+    std::string getTokenValue(Vera::Structures::SourceFiles::FileId fileId,
+        const char * values) const
     {
         if (id_ == boost::wave::T_NEWLINE)
         {
@@ -56,17 +124,17 @@ struct TokenRef
         }
         else if (index_ >= 0)
         {
-            // token value stored in the physicalTokens structure
+            // token value stored in the values of the file
             // (this is used with line continuation and other cases
             // where the token has no representation in physical lines)
 
-            return physicalTokens[static_cast<size_t>(index_)];
+            return std::string(values + index_, static_cast<std::size_t>(length_));
         }
         else
         {
             // token value has to be retrieved from the physical line collection
 
-            return Vera::Structures::SourceLines::getLine(fileName, line_).substr(column_, length_);
+            return getSourceText(fileId, line_, column_, length_);
         }
     }
 
@@ -75,7 +143,7 @@ struct TokenRef
     int column_;
     int length_;
 
-    // if >= 0, it is the index into the physicalTokens collection,
+    // if >= 0, it is the offset of the value in the values of the file,
     // used only for line continuation
     // and when line_ and column_ do not reflect the physical layout:
     int index_;
@@ -83,10 +151,55 @@ struct TokenRef
 
 typedef std::vector<TokenRef> TokenCollection;
 
-typedef std::map<Vera::Structures::SourceFiles::FileName, TokenCollection> FileTokenCollection;
+// the tokens of a file while it is parsed, sized from the length of the source
+struct ParsedTokens
+{
+    explicit ParsedTokens(std::size_t sourceLength) : errorLine_(0)
+    {
+        // about one token every four characters, counting the spaces and the newlines
+        tokens_.reserve(sourceLength / 4 + 1);
+    }
+
+    TokenCollection tokens_;
+
+    // the values of the tokens that are not references to the source
+    std::string values_;
+
+    // the lexers don't report anything, so the files can be lexed in parallel
+    int errorLine_;
+    std::string error_;
+};
+
+struct FileTokens
+{
+    FileTokens() : parsed_(false), size_(0), tokens_(0), tokenCount_(0), values_(0) {}
+
+    bool parsed_;
+
+    // the tokens and then their values, in a single block allocated once the
+    // file is parsed and released at once when it is unloaded
+    boost::shared_array<char> arena_;
+    std::size_t size_;
+
+    const TokenRef * tokens_;
+    std::size_t tokenCount_;
+    const char * values_;
+};
+
+// indexed by file id
+typedef std::vector<FileTokens> FileTokenCollection;
 
 FileTokenCollection fileTokens_;
 
+FileTokens & getFileTokens(Vera::Structures::SourceFiles::FileId id)
+{
+    if (static_cast<std::size_t>(id) >= fileTokens_.size())
+    {
+        fileTokens_.resize(id + 1);
+    }
+    return fileTokens_[id];
+}
+
 typedef std::vector<boost::function<bool (boost::wave::token_id)> > CompiledFilterSequence;
 
 boost::wave::token_id tokenIdFromTokenFilter(const Vera::Structures::Tokens::TokenFilter & filter)
@@ -263,6 +376,31 @@ boost::wave::token_id tokenIdFromTokenFilter(const Vera::Structures::Tokens::Tok
         tokenMap["msext_region"] = static_cast<boost::wave::token_id>(419);
         tokenMap["msext_endregion"] = static_cast<boost::wave::token_id>(420);
         tokenMap["import"] = static_cast<boost::wave::token_id>(421);
+        tokenMap["alignas"] = static_cast<boost::wave::token_id>(422);
+        tokenMap["alignof"] = static_cast<boost::wave::token_id>(423);
+        tokenMap["char16_t"] = static_cast<boost::wave::token_id>(424);
+        tokenMap["char32_t"] = static_cast<boost::wave::token_id>(425);
+        tokenMap["constexpr"] = static_cast<boost::wave::token_id>(426);
+        tokenMap["decltype"] = static_cast<boost::wave::token_id>(427);
+        tokenMap["noexcept"] = static_cast<boost::wave::token_id>(428);
+        tokenMap["nullptr"] = static_cast<boost::wave::token_id>(429);
+        tokenMap["static_assert"] = static_cast<boost::wave::token_id>(430);
+        tokenMap["threadlocal"] = static_cast<boost::wave::token_id>(431);
+        tokenMap["rawstringlit"] = static_cast<boost::wave::token_id>(432);
+
+        // the tokens unknown to Wave
+        typedef Vera::Structures::TokenIds TokenIds;
+        tokenMap["char8_t"] = BASEID_FROM_TOKEN(TokenIds::T_CHAR8_T);
+        tokenMap["concept"] = BASEID_FROM_TOKEN(TokenIds::T_CONCEPT);
+        tokenMap["consteval"] = BASEID_FROM_TOKEN(TokenIds::T_CONSTEVAL);
+        tokenMap["constinit"] = BASEID_FROM_TOKEN(TokenIds::T_CONSTINIT);
+        tokenMap["co_await"] = BASEID_FROM_TOKEN(TokenIds::T_CO_AWAIT);
+        tokenMap["co_return"] = BASEID_FROM_TOKEN(TokenIds::T_CO_RETURN);
+        tokenMap["co_yield"] = BASEID_FROM_TOKEN(TokenIds::T_CO_YIELD);
+        tokenMap["requires"] = BASEID_FROM_TOKEN(TokenIds::T_REQUIRES);
+        tokenMap["spaceship"] = BASEID_FROM_TOKEN(TokenIds::T_SPACESHIP);
+        tokenMap["pp_elifdef"] = BASEID_FROM_TOKEN(TokenIds::T_PP_ELIFDEF);
+        tokenMap["pp_elifndef"] = BASEID_FROM_TOKEN(TokenIds::T_PP_ELIFNDEF);
     }
 
     const TokenFilterToIdMap::const_iterator it = tokenMap.find(filter);
@@ -334,104 +472,398 @@ struct LineNumberComparator
     }
 };
 
-void findRange(const TokenCollection & tokens, int fromLine, int toLine,
-    TokenCollection::const_iterator & beg, TokenCollection::const_iterator & end)
+void findRange(const FileTokens & fileTokens, int fromLine, int toLine,
+    const TokenRef * & beg, const TokenRef * & end)
 {
+    const TokenRef * first = fileTokens.tokens_;
+    const TokenRef * last = fileTokens.tokens_ + fileTokens.tokenCount_;
+
     const TokenRef tokenToCompareFrom(boost::wave::token_id(), fromLine, 0, 0);
-    beg = lower_bound(tokens.begin(), tokens.end(), tokenToCompareFrom, LineNumberComparator());
+    beg = std::lower_bound(first, last, tokenToCompareFrom, LineNumberComparator());
 
     if (toLine < 0)
     {
-        end = tokens.end();
+        end = last;
     }
     else
     {
         const TokenRef tokenToCompareTo(boost::wave::token_id(), toLine, 0, 0);
-        end = upper_bound(tokens.begin(), tokens.end(), tokenToCompareTo, LineNumberComparator());
+        end = std::upper_bound(first, last, tokenToCompareTo, LineNumberComparator());
     }
 }
 
-} // unnamed namespace
+// the parsed tokens are moved to the arena of the file
+void storeTokens(FileTokens & fileTokens, const ParsedTokens & parsed)
+{
+    const std::size_t tokensSize = parsed.tokens_.size() * sizeof(TokenRef);
+    const std::size_t size = tokensSize + parsed.values_.size();
+    if (size == 0)
+    {
+        return;
+    }
 
-namespace Vera
+    // new[] gives a block aligned for any type that fits in it
+    boost::shared_array<char> arena(new char[size]);
+    TokenRef * tokens = reinterpret_cast<TokenRef *>(arena.get());
+    std::uninitialized_copy(parsed.tokens_.begin(), parsed.tokens_.end(), tokens);
+    std::copy(parsed.values_.begin(), parsed.values_.end(), arena.get() + tokensSize);
+
+    fileTokens.arena_.swap(arena);
+    fileTokens.size_ = size;
+    fileTokens.tokens_ = tokens;
+    fileTokens.tokenCount_ = parsed.tokens_.size();
+    fileTokens.values_ = fileTokens.arena_.get() + tokensSize;
+}
+
+void addToken(ParsedTokens & fileTokens,
+    const Vera::Structures::SourceLines::LineCollection & lines, boost::wave::token_id id,
+    int line, int column, const std::string & value)
 {
-namespace Structures
+    const int length = static_cast<int>(value.size());
+
+    bool useReference = true;
+    if (id == boost::wave::T_NEWLINE || id == boost::wave::T_EOF
+        || line > static_cast<int>(lines.size()))
+    {
+        useReference = false;
+    }
+    else
+    {
+        useReference = isInSource(lines, line, column, value);
+    }
+
+    if (useReference)
+    {
+        // the reference representation of the token is stored
+
+        fileTokens.tokens_.push_back(TokenRef(id, line, column, length));
+    }
+    else
+    {
+        // value of the token has no representation in the physical line
+        // so the real token value is stored in the values of the file
+
+        fileTokens.tokens_.push_back(TokenRef(id, line, column, value, fileTokens.values_));
+    }
+}
+
+void parseWithWave(const Vera::Structures::SourceFiles::FileName & name,
+    const Vera::Structures::Tokens::FileContent & src,
+    const Vera::Structures::SourceLines::LineCollection & lines, ParsedTokens & fileTokens)
+{
+    try
+    {
+        typedef boost::wave::cpplexer::lex_token<> token_type;
+        typedef boost::wave::cpplexer::lex_iterator<token_type> lexer_type;
+        typedef token_type::position_type position_type;
+
+        const position_type pos(name.c_str());
+        lexer_type it = lexer_type(src.begin(), src.end(), pos,
+            boost::wave::language_support(boost::wave::support_cpp0x));
+        const lexer_type end = lexer_type();
+
+        for ( ; it != end; ++it)
+        {
+            boost::wave::token_id id(*it);
+
+            const token_type::position_type pos = it->get_position();
+            std::string value = it->get_value().c_str();
+
+            if (id == boost::wave::T_IDENTIFIER)
+            {
+                // the keywords of C++ 20 are unknown to Wave
+                id = Vera::Structures::FastLexer::getKeywordId(value, false);
+            }
+            else if (id == boost::wave::T_THREADLOCAL)
+            {
+                // misspelled by Wave
+                value = "thread_local";
+            }
+
+            addToken(fileTokens, lines, id, pos.get_line(), pos.get_column() - 1, value);
+        }
+    }
+    catch (const boost::wave::cpplexer::cpplexer_exception & e)
+    {
+        std::ostringstream ss;
+        ss << "illegal token in column " << e.column_no()
+            << ", giving up (hint: fix the file or remove it from the working set)";
+        fileTokens.errorLine_ = e.line_no();
+        fileTokens.error_ = ss.str();
+    }
+}
+
+// the Microsoft extensions are a compile time option of the Wave library
+bool waveSupportsMsExtensions()
 {
+    typedef boost::wave::cpplexer::lex_token<> token_type;
+    typedef boost::wave::cpplexer::lex_iterator<token_type> lexer_type;
 
-void Tokens::parse(const SourceFiles::FileName & name, const FileContent & src)
+    const std::string src = "__int8";
+    const lexer_type it = lexer_type(src.begin(), src.end(), token_type::position_type(),
+        boost::wave::language_support(boost::wave::support_cpp));
+    return boost::wave::token_id(*it) == boost::wave::T_MSEXT_INT8;
+}
+
+void parseWithFastLexer(const Vera::Structures::Tokens::FileContent & src,
+    const Vera::Structures::SourceLines::LineCollection & lines, ParsedTokens & fileTokens)
 {
-    TokenCollection & tokensInFile = fileTokens_[name];
+    static const bool msExtensions = waveSupportsMsExtensions();
 
-    // wave throws exceptions when given an empty file
-    if (src.empty() == false)
+    const int lineCount = static_cast<int>(lines.size());
+
+    // offset of the line in the source, as the tokens come in the order of the lines
+    int line = 1;
+    int lineOffset = 0;
+
+    Vera::Structures::FastLexer lexer(src, msExtensions);
+    Vera::Structures::FastLexer::Token token;
+    while (lexer.next(token))
     {
-        try
+        while (line < token.line_ && line <= lineCount)
         {
-            typedef boost::wave::cpplexer::lex_token<> token_type;
-            typedef boost::wave::cpplexer::lex_iterator<token_type> lexer_type;
-            typedef token_type::position_type position_type;
+            lineOffset += static_cast<int>(lines[line - 1].size()) + 1;
+            ++line;
+        }
 
-            const position_type pos(name.c_str());
-            lexer_type it = lexer_type(src.begin(), src.end(), pos,
-                boost::wave::language_support(
-                    boost::wave::support_cpp | boost::wave::support_option_long_long));
-            const lexer_type end = lexer_type();
+        // the tokens over several lines, as the multi-line raw strings,
+        // are also references to the source
+        const int length = token.end_ - token.begin_;
+        if (token.inSource_ && token.line_ == line && line <= lineCount &&
+            token.offset_ == lineOffset + token.column_)
+        {
+            fileTokens.tokens_.push_back(
+                TokenRef(token.id_, token.line_, token.column_, length));
+        }
+        else
+        {
+            addToken(fileTokens, lines,
+                token.id_, token.line_, token.column_, lexer.getValue(token));
+        }
+    }
+}
 
-            const int lineCount = SourceLines::getLineCount(name);
+// a file to lex, with the data read by the lexers, which must not change
+// while they run
+struct LexJob
+{
+    LexJob(const Vera::Structures::SourceFiles::FileName & name,
+        const Vera::Structures::Tokens::FileContent & src,
+        const Vera::Structures::SourceLines::LineCollection & lines)
+        : name_(&name), src_(&src), lines_(&lines) {}
+
+    const Vera::Structures::SourceFiles::FileName * name_;
+    const Vera::Structures::Tokens::FileContent * src_;
+    const Vera::Structures::SourceLines::LineCollection * lines_;
+    boost::shared_ptr<ParsedTokens> parsed_;
+};
 
-            for ( ; it != end; ++it)
-            {
-                const boost::wave::token_id id(*it);
+void lex(LexJob & job)
+{
+    Vera::Plugins::Trace::Span span("lex", fastLexer ? "fast lexer" : "wave lexer", *job.name_);
+    job.parsed_.reset(new ParsedTokens(job.src_->size()));
+    if (fastLexer)
+    {
+        parseWithFastLexer(*job.src_, *job.lines_, *job.parsed_);
+    }
+    else
+    {
+        parseWithWave(*job.name_, *job.src_, *job.lines_, *job.parsed_);
+    }
+}
 
-                const token_type::position_type pos = it->get_position();
-                const std::string value = it->get_value().c_str();
-                const int line = pos.get_line();
-                const int column = pos.get_column() - 1;
-                const int length = static_cast<int>(value.size());
+FileTokens & resetFileTokens(Vera::Structures::SourceFiles::FileId id)
+{
+    FileTokens & fileTokens = getFileTokens(id);
+    fileTokens = FileTokens();
+    fileTokens.parsed_ = true;
+    return fileTokens;
+}
 
-                bool useReference = true;
-                if (id == boost::wave::T_NEWLINE || id == boost::wave::T_EOF || line > lineCount)
-                {
-                    useReference = false;
-                }
-                else
-                {
-                    const std::string & sourceLine = SourceLines::getLine(name, line);
-                    if (column > static_cast<int>(sourceLine.size()) ||
-                        value != sourceLine.substr(column, length))
-                    {
-                        useReference = false;
-                    }
-                }
+typedef std::vector<LexJob> LexJobCollection;
 
-                if (useReference)
-                {
-                    // the reference representation of the token is stored
+// The jobs are taken in turn by the threads. The first failure is kept to be
+// thrown again by the calling thread.
+class ParallelLexer
+{
+public:
+    explicit ParallelLexer(LexJobCollection & jobs) : jobs_(jobs), next_(0) {}
 
-                    tokensInFile.push_back(TokenRef(id, line, column, length));
-                }
-                else
-                {
-                    // value of the token has no representation in the physical line
-                    // so the real token value is stored in physicalTokens
+    void run()
+    {
+        const std::size_t threads = std::min<std::size_t>(
+            std::max(1u, boost::thread::hardware_concurrency()), jobs_.size());
+        if (threads <= 1)
+        {
+            work();
+        }
+        else
+        {
+            boost::thread_group group;
+            for (std::size_t i = 0; i != threads; ++i)
+            {
+                group.create_thread(boost::bind(&ParallelLexer::work, this));
+            }
+            group.join_all();
+        }
+        if (failure_.empty() == false)
+        {
+            throw Vera::Structures::TokensError(failure_);
+        }
+    }
 
-                    tokensInFile.push_back(TokenRef(id, line, column, length, value));
+private:
+    void work()
+    {
+        while (true)
+        {
+            std::size_t i;
+            {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                if (next_ == jobs_.size() || failure_.empty() == false)
+                {
+                    return;
                 }
+                i = next_++;
+            }
+
+            try
+            {
+                lex(jobs_[i]);
+            }
+            catch (const std::exception & e)
+            {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                failure_ = "cannot lex " + *jobs_[i].name_ + ": " + e.what();
             }
         }
-        catch (const boost::wave::cpplexer::cpplexer_exception & e)
+    }
+
+    LexJobCollection & jobs_;
+    boost::mutex mutex_;
+    std::size_t next_;
+    std::string failure_;
+};
+
+// the tokens of the job are stored, with the error of the lexer if any
+void storeJob(Vera::Structures::SourceFiles::FileId fileId, const LexJob & job)
+{
+    FileTokens & fileTokens = resetFileTokens(fileId);
+    storeTokens(fileTokens, *job.parsed_);
+    if (job.parsed_->error_.empty() == false)
+    {
+        Vera::Plugins::Reports::internal(*job.name_, job.parsed_->errorLine_,
+            job.parsed_->error_);
+    }
+    Vera::Plugins::Profiler::addCount(Vera::Plugins::Profiler::bytesLexed, job.src_->size());
+    Vera::Plugins::Profiler::addCount(Vera::Plugins::Profiler::tokensLexed,
+        fileTokens.tokenCount_);
+}
+
+} // unnamed namespace
+
+namespace Vera
+{
+namespace Structures
+{
+
+void Tokens::setLexer(const LexerName & name)
+{
+    if (name == "fast")
+    {
+        fastLexer = true;
+    }
+    else if (name == "wave")
+    {
+        fastLexer = false;
+    }
+    else
+    {
+        throw TokensError("unknown lexer: " + name);
+    }
+}
+
+void Tokens::parse(SourceFiles::FileId fileId, const FileContent & src)
+{
+    // wave throws exceptions when given an empty file
+    if (src.empty())
+    {
+        resetFileTokens(fileId);
+        return;
+    }
+
+    Plugins::Profiler::Phase phase("lex");
+    LexJob job(SourceFiles::getFileName(fileId), src, SourceLines::getAllLines(fileId));
+    lex(job);
+    storeJob(fileId, job);
+    phase.addBytes(getFileTokens(fileId).size_);
+}
+
+void Tokens::parse(const SourceFiles::FileIdCollection & fileIds,
+    const FileContentCollection & sources)
+{
+    Plugins::Profiler::Phase phase("lex");
+
+    // the lines are loaded before the threads start
+    LexJobCollection jobs;
+    jobs.reserve(fileIds.size());
+    SourceFiles::FileIdCollection jobIds;
+    for (std::size_t i = 0; i != fileIds.size(); ++i)
+    {
+        if (sources[i].empty())
+        {
+            resetFileTokens(fileIds[i]);
+        }
+        else
         {
-            std::ostringstream ss;
-            ss << "illegal token in column " << e.column_no()
-                << ", giving up (hint: fix the file or remove it from the working set)";
-            Plugins::Reports::internal(name, e.line_no(), ss.str());
+            jobs.push_back(LexJob(SourceFiles::getFileName(fileIds[i]), sources[i],
+                SourceLines::getAllLines(fileIds[i])));
+            jobIds.push_back(fileIds[i]);
         }
     }
+
+    ParallelLexer(jobs).run();
+
+    for (std::size_t i = 0; i != jobs.size(); ++i)
+    {
+        storeJob(jobIds[i], jobs[i]);
+        phase.addBytes(getFileTokens(jobIds[i]).size_);
+    }
+}
+
+void Tokens::unload(SourceFiles::FileId fileId)
+{
+    if (static_cast<std::size_t>(fileId) < fileTokens_.size())
+    {
+        fileTokens_[fileId] = FileTokens();
+    }
+}
+
+std::size_t Tokens::getMemoryUsage(SourceFiles::FileId fileId)
+{
+    return getFileTokens(fileId).size_;
+}
+
+std::size_t Tokens::getTokenCount(SourceFiles::FileId fileId)
+{
+    return getFileTokens(fileId).tokenCount_;
 }
 
 Tokens::TokenSequence Tokens::getTokens(const SourceFiles::FileName & fileName,
     int fromLine, int fromColumn, int toLine, int toColumn,
     const FilterSequence & filter)
+{
+    // called by the scripts
+    Plugins::Trace::Span span("binding", "getTokens", fileName);
+    const SourceFiles::FileId id = SourceFiles::getFileId(fileName);
+    TokenSequence tokens = getTokens(id, fromLine, fromColumn, toLine, toColumn, filter);
+    Plugins::CallStats::countGetTokens(id, fromLine, toLine, filter, tokens.size());
+    return tokens;
+}
+
+Tokens::TokenSequence Tokens::getTokens(SourceFiles::FileId fileId,
+    int fromLine, int fromColumn, int toLine, int toColumn,
+    const FilterSequence & filter)
 {
     if ((fromLine < 1) ||
         (fromColumn < 0) ||
@@ -441,13 +873,14 @@ Tokens::TokenSequence Tokens::getTokens(const SourceFiles::FileName & fileName,
         throw TokensError("illegal range of tokens requested by the script");
     }
 
+    // lazy load and parse, or reload of an unloaded file, which also makes
+    // it the most recently used one
+    SourceLines::getAllLines(fileId);
+    const bool parsed = getFileTokens(fileId).parsed_;
+    Plugins::Profiler::countCacheUse(Plugins::Profiler::tokensCache, parsed);
+    if (parsed == false)
     {
-        // lazy load and parse
-        const FileTokenCollection::const_iterator fit = fileTokens_.find(fileName);
-        if (fit == fileTokens_.end())
-        {
-            SourceLines::loadFile(fileName);
-        }
+        SourceLines::parseTokens(fileId);
     }
 
     // here we know that the file is already loaded and parsed
@@ -455,16 +888,16 @@ Tokens::TokenSequence Tokens::getTokens(const SourceFiles::FileName & fileName,
 
     const CompiledFilterSequence compiledFilter = prepareCompiledFilter(filter);
 
-    const TokenCollection & tokensInFile = fileTokens_[fileName];
+    const FileTokens & fileTokens = fileTokens_[fileId];
 
     TokenSequence ret;
 
-    TokenCollection::const_iterator begin;
-    TokenCollection::const_iterator end;
+    const TokenRef * begin;
+    const TokenRef * end;
 
-    findRange(tokensInFile, fromLine, toLine, begin, end);
+    findRange(fileTokens, fromLine, toLine, begin, end);
 
-    for (TokenCollection::const_iterator it = begin; it != end; ++it)
+    for (const TokenRef * it = begin; it != end; ++it)
     {
         const TokenRef & token = *it;
 
@@ -476,13 +909,13 @@ Tokens::TokenSequence Tokens::getTokens(const SourceFiles::FileName & fileName,
         {
             if (match(compiledFilter, token.id_))
             {
-                std::string tokenName = boost::wave::get_token_name(token.id_).c_str();
+                std::string tokenName = TokenIds::getName(token.id_);
                 boost::algorithm::to_lower(tokenName);
 
                 std::string value;
                 if (tokenName != "eof")
                 {
-                    value = token.getTokenValue(fileName);
+                    value = token.getTokenValue(fileId, fileTokens.values_);
                 }
 
                 ret.push_back(Token(value, line, column, tokenName));
@@ -493,5 +926,24 @@ Tokens::TokenSequence Tokens::getTokens(const SourceFiles::FileName & fileName,
     return ret;
 }
 
+struct Tokens::State
+{
+    State() : fastLexer_(false) {}
+
+    bool fastLexer_;
+    FileTokenCollection fileTokens_;
+};
+
+boost::shared_ptr<Tokens::State> Tokens::createState()
+{
+    return boost::shared_ptr<State>(new State());
+}
+
+void Tokens::swapState(State & state)
+{
+    std::swap(fastLexer, state.fastLexer_);
+    fileTokens_.swap(state.fileTokens_);
+}
+
 }
 }
@@ -11,6 +11,7 @@
 #include "SourceFiles.h"
 #include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 
 namespace Vera
@@ -51,6 +52,7 @@ class Tokens
 {
 public:
     typedef std::string FileContent;
+    typedef std::vector<FileContent> FileContentCollection;
 
     typedef std::vector<Token> TokenSequence;
 
@@ -58,11 +60,38 @@ public:
 
     typedef std::vector<TokenFilter> FilterSequence;
 
-    static void parse(const SourceFiles::FileName & name, const FileContent & src);
+    typedef std::string LexerName;
+
+    // "wave" (the default), which only knows the lexical grammar of C++ 11, or "fast"
+    static void setLexer(const LexerName & name);
+
+    static void parse(SourceFiles::FileId fileId, const FileContent & src);
+
+    // The files are lexed in parallel, then their tokens are stored in order.
+    // Their lines must be loaded, and stay loaded.
+    static void parse(const SourceFiles::FileIdCollection & fileIds,
+        const FileContentCollection & sources);
+
+    // releases the tokens of the file, which is parsed again by the next getTokens
+    static void unload(SourceFiles::FileId fileId);
+
+    // in bytes
+    static std::size_t getMemoryUsage(SourceFiles::FileId fileId);
+
+    // 0 if the file is not parsed
+    static std::size_t getTokenCount(SourceFiles::FileId fileId);
 
     static TokenSequence getTokens(const SourceFiles::FileName & name,
         int fromLine, int fromColumn, int toLine, int toColumn,
         const FilterSequence & filter);
+    static TokenSequence getTokens(SourceFiles::FileId id,
+        int fromLine, int fromColumn, int toLine, int toColumn,
+        const FilterSequence & filter);
+
+    // see SourceFiles::State
+    struct State;
+    static boost::shared_ptr<State> createState();
+    static void swapState(State & state);
 };
 
 } // namespace Structures
@@ -0,0 +1,15 @@
+#!/usr/bin/tclsh
+# Fetches all the tokens of the file for each of its lines
+# needs: lines tokens
+# scope: file
+
+foreach f [getSourceFileNames] {
+    set lineCount [getLineCount $f]
+    for {set i 1} {$i <= $lineCount} {incr i} {
+        getTokens $f 1 0 -1 -1 {}
+        getLine $f $i
+        getLine $f $i
+    }
+    set identifiers [getTokens $f 1 0 2 0 {identifier}]
+    report $f 1 "[llength $identifiers] identifiers on the first line"
+}
@@ -0,0 +1,10 @@
+#include <vector>
+#  define MAX(a, b) \
+    ((a) > (b) ? (a) : (b))
+%:if defined(X) and not defined(Y)
+??=pragma once
+#endif
+/* two
+   lines */ long x = 0x1fULL + 1.5e-3f + L'\n'
+char const * s = "a \"b\"" "??/""
+x <<= a ??( 1 ??) ??' y->*z
@@ -0,0 +1,6 @@
+#!/usr/bin/tclsh
+# scope: tree
+
+foreach f [getSourceFileNames] {
+    report $f 1 "never reported"
+}
@@ -0,0 +1,8 @@
+#!/usr/bin/tclsh
+# Reports the number of files seen by a rule of the file scope
+# needs: names
+# scope: file
+
+foreach f [getSourceFileNames] {
+    report $f 1 "[llength [getSourceFileNames]] files"
+}
@@ -0,0 +1,5 @@
+auto s = R"x(a
+b)x" u8"c"_s
+constexpr char8_t c = u8'c' <=> 1'000'000ULL + 0x1.8p3 + 12_km
+co_await std::vector<::std::string>
+#elifdef FOO
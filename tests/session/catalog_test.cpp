@@ -0,0 +1,100 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// The scripts of a root modified between the runs: with the hot reload, the
+// modified and the new scripts are used; without it, the scripts of the first
+// read are used.
+
+#include "Session.h"
+#include <boost/filesystem.hpp>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+
+namespace // unnamed
+{
+
+void writeRule(const boost::filesystem::path & rules, const std::string & name,
+    const std::string & message, std::time_t modified)
+{
+    const boost::filesystem::path path = rules / (name + ".tcl");
+    std::ofstream file(path.string().c_str());
+    file << "foreach f [getSourceFileNames] {\n"
+        << "    report $f 1 \"" << message << "\"\n"
+        << "}\n";
+    file.close();
+
+    // later than the previous version, even in the same second
+    boost::filesystem::last_write_time(path, modified);
+    boost::filesystem::last_write_time(rules, modified);
+}
+
+void check(const char * title, const std::string & root, const char * rule1, const char * rule2)
+{
+    Vera::Session session;
+    session.setRootDirectory(root);
+
+    Vera::Session::Buffer buffer;
+    buffer.name_ = "a.cpp";
+    buffer.content_ = "int a;\n";
+    session.addBuffers(Vera::Session::BufferCollection(1, buffer));
+
+    session.executeRule(rule1);
+    if (rule2 != 0)
+    {
+        session.executeRule(rule2);
+    }
+
+    std::cout << title << '\n';
+    const Vera::Session::ReportCollection reports = session.getReports(false);
+    for (Vera::Session::ReportCollection::const_iterator it = reports.begin();
+         it != reports.end(); ++it)
+    {
+        std::cout << it->fileName_ << ':' << it->lineNumber_ << ": (" << it->rule_ << ") "
+            << it->message_ << '\n';
+    }
+}
+
+} // unnamed namespace
+
+int main(int argc, char * argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: catalog_test root" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const boost::filesystem::path root(argv[1]);
+        const boost::filesystem::path rules = root / "rules";
+        boost::filesystem::remove_all(root);
+        boost::filesystem::create_directories(rules);
+        const std::time_t now = std::time(0);
+
+        Vera::Session::setHotReload(true);
+        writeRule(rules, "R1", "first version", now);
+        check("first run", root.string(), "R1", 0);
+
+        writeRule(rules, "R1", "second version", now + 10);
+        writeRule(rules, "R2", "new rule", now + 10);
+        check("hot reload", root.string(), "R1", "R2");
+
+        Vera::Session::setHotReload(false);
+        writeRule(rules, "R1", "third version", now + 20);
+        check("no reload", root.string(), "R1", 0);
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << "catalog_test: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
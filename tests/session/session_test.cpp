@@ -0,0 +1,92 @@
+//
+// Copyright (C) 2006-2007 Maciej Sobczak
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Two sessions used in turn and then at the same time, with different
+// parameters and files: each one must only see its own data, and the data of
+// the process must be left untouched.
+
+#include "Session.h"
+#include "structures/SourceFiles.h"
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <cstdlib>
+#include <iostream>
+
+
+namespace // unnamed
+{
+
+void write(const char * name, Vera::Session & session)
+{
+    const Vera::Session::ReportCollection reports = session.getReports(true);
+    std::cout << name << ": " << session.countFiles() << " files, "
+        << session.countReports() << " reports, " << reports.size() << " distinct\n";
+    for (Vera::Session::ReportCollection::const_iterator it = reports.begin();
+         it != reports.end(); ++it)
+    {
+        std::cout << it->fileName_ << ':' << it->lineNumber_ << ": (" << it->rule_ << ") "
+            << it->message_ << '\n';
+    }
+}
+
+void executeRules(Vera::Session & session)
+{
+    for (int i = 0; i != 10; ++i)
+    {
+        session.executeRule("L004");
+    }
+}
+
+} // unnamed namespace
+
+int main(int argc, char * argv[])
+{
+    if (argc != 4)
+    {
+        std::cerr << "usage: session_test root file1 file2" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        Vera::Session first;
+        Vera::Session second;
+
+        first.setRootDirectory(argv[1]);
+        second.setRootDirectory(argv[1]);
+        first.setParameter("max-line-length", "99");
+        second.setParameter("max-line-length", "60");
+        first.addFile(argv[2]);
+        second.addFile(argv[2]);
+        second.addFile(argv[3]);
+
+        Vera::Session::Buffer buffer;
+        buffer.name_ = "unsaved.cpp";
+        buffer.content_ = "int a;\nint aVariableWithAVeryLongNameThatTakesMoreThanSixtyCharacters;\n";
+        second.addBuffers(Vera::Session::BufferCollection(1, buffer));
+
+        second.executeRule("L004");
+        first.executeRule("L004");
+        second.executeRule("T009");
+        write("first", first);
+        write("second", second);
+
+        boost::thread thread(boost::bind(executeRules, boost::ref(first)));
+        executeRules(second);
+        thread.join();
+        write("first", first);
+        write("second", second);
+
+        std::cout << "process: " << Vera::Structures::SourceFiles::count() << " files\n";
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << "session_test: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,8 @@
+#!/usr/bin/tclsh
+# reports the tokens of the later standards
+
+foreach f [getSourceFileNames] {
+    foreach t [getTokens $f 1 0 -1 -1 {rawstringlit constexpr char8_t spaceship co_await pp_elifdef}] {
+        report $f [lindex $t 1] "[lindex $t 3]: [lindex $t 0]"
+    }
+}